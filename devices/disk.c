@@ -48,6 +48,10 @@
 #define CMD_READ_SECTOR_RETRY 0x20      /* READ SECTOR with retries. */
 #define CMD_WRITE_SECTOR_RETRY 0x30     /* WRITE SECTOR with retries. */
 
+/* Most sectors transferred by one READ or WRITE SECTOR command.
+   The sector count register holds 256 as 0. */
+#define MULTIPLE_MAX 256
+
 /* An ATA device. */
 struct disk {
 	char name[8];               /* Name, e.g. "hd0:1". */
@@ -84,7 +88,7 @@ static void reset_channel (struct channel *);
 static bool check_device_type (struct disk *);
 static void identify_ata_device (struct disk *);
 
-static void select_sector (struct disk *, disk_sector_t);
+static void select_sector (struct disk *, disk_sector_t, size_t cnt);
 static void issue_pio_command (struct channel *, uint8_t command);
 static void input_sector (struct channel *, void *);
 static void output_sector (struct channel *, const void *);
@@ -216,7 +220,7 @@ disk_read (struct disk *d, disk_sector_t sec_no, void *buffer) {
 
 	c = d->channel;
 	lock_acquire (&c->lock);
-	select_sector (d, sec_no);
+	select_sector (d, sec_no, 1);
 	issue_pio_command (c, CMD_READ_SECTOR_RETRY);
 	sema_down (&c->completion_wait);
 	if (!wait_while_busy (d))
@@ -240,7 +244,7 @@ disk_write (struct disk *d, disk_sector_t sec_no, const void *buffer) {
 
 	c = d->channel;
 	lock_acquire (&c->lock);
-	select_sector (d, sec_no);
+	select_sector (d, sec_no, 1);
 	issue_pio_command (c, CMD_WRITE_SECTOR_RETRY);
 	if (!wait_while_busy (d))
 		PANIC ("%s: disk write failed, sector=%"PRDSNu, d->name, sec_no);
@@ -250,6 +254,109 @@ disk_write (struct disk *d, disk_sector_t sec_no, const void *buffer) {
 	lock_release (&c->lock);
 }
 
+/* Reads CNT consecutive sectors starting at SEC_NO from disk D
+   into BUFFER, which must have room for CNT * DISK_SECTOR_SIZE
+   bytes.  Each command transfers up to MULTIPLE_MAX sectors, so
+   the controller is programmed once per run rather than once per
+   sector.  Otherwise like disk_read(). */
+void
+disk_read_multiple (struct disk *d, disk_sector_t sec_no, void *buffer,
+		size_t cnt) {
+	disk_read_scatter (d, sec_no, &buffer, 1, cnt);
+}
+
+/* Reads consecutive sectors of disk D starting at SEC_NO into the
+   BUF_CNT buffers in BUFS, each BUF_SECTORS sectors long, as though
+   they were one buffer passed to disk_read_multiple().  The
+   counterpart of disk_write_gather(). */
+void
+disk_read_scatter (struct disk *d, disk_sector_t sec_no,
+		void *const bufs[], size_t buf_cnt, size_t buf_sectors) {
+	size_t cnt = buf_cnt * buf_sectors;
+	size_t done = 0;
+	struct channel *c;
+
+	ASSERT (d != NULL);
+	ASSERT (bufs != NULL);
+
+	c = d->channel;
+	lock_acquire (&c->lock);
+	while (done < cnt) {
+		size_t n = cnt - done < MULTIPLE_MAX ? cnt - done : MULTIPLE_MAX;
+		size_t i;
+
+		select_sector (d, sec_no, n);
+		issue_pio_command (c, CMD_READ_SECTOR_RETRY);
+		for (i = 0; i < n; i++, done++) {
+			uint8_t *buffer = bufs[done / buf_sectors];
+
+			ASSERT (buffer != NULL);
+
+			/* The device interrupts once per sector, when its data
+			   is ready. */
+			sema_down (&c->completion_wait);
+			if (!wait_while_busy (d))
+				PANIC ("%s: disk read failed, sector=%"PRDSNu,
+						d->name, (disk_sector_t) (sec_no + i));
+			input_sector (c, buffer + done % buf_sectors * DISK_SECTOR_SIZE);
+		}
+		d->read_cnt += n;
+		sec_no += n;
+	}
+	lock_release (&c->lock);
+}
+
+/* Writes CNT consecutive sectors starting at SEC_NO to disk D from
+   BUFFER, which must contain CNT * DISK_SECTOR_SIZE bytes, like
+   disk_read_multiple(). */
+void
+disk_write_multiple (struct disk *d, disk_sector_t sec_no,
+		const void *buffer, size_t cnt) {
+	disk_write_gather (d, sec_no, &buffer, 1, cnt);
+}
+
+/* Writes BUF_CNT buffers from BUFS, each BUF_SECTORS sectors long,
+   to consecutive sectors of disk D starting at SEC_NO, as though
+   they were one buffer passed to disk_write_multiple().  Lets a
+   caller write scattered pages to one run of sectors in a single
+   transfer. */
+void
+disk_write_gather (struct disk *d, disk_sector_t sec_no,
+		const void *const bufs[], size_t buf_cnt, size_t buf_sectors) {
+	size_t cnt = buf_cnt * buf_sectors;
+	size_t done = 0;
+	struct channel *c;
+
+	ASSERT (d != NULL);
+	ASSERT (bufs != NULL);
+
+	c = d->channel;
+	lock_acquire (&c->lock);
+	while (done < cnt) {
+		size_t n = cnt - done < MULTIPLE_MAX ? cnt - done : MULTIPLE_MAX;
+		size_t i;
+
+		select_sector (d, sec_no, n);
+		issue_pio_command (c, CMD_WRITE_SECTOR_RETRY);
+		for (i = 0; i < n; i++, done++) {
+			const uint8_t *buffer = bufs[done / buf_sectors];
+
+			ASSERT (buffer != NULL);
+
+			/* The device interrupts once per sector, after taking
+			   its data. */
+			if (!wait_while_busy (d))
+				PANIC ("%s: disk write failed, sector=%"PRDSNu,
+						d->name, (disk_sector_t) (sec_no + i));
+			output_sector (c, buffer + done % buf_sectors * DISK_SECTOR_SIZE);
+			sema_down (&c->completion_wait);
+		}
+		d->write_cnt += n;
+		sec_no += n;
+	}
+	lock_release (&c->lock);
+}
+
 /* Disk detection and identification. */
 
 static void print_ata_string (char *string, size_t size);
@@ -402,17 +509,18 @@ print_ata_string (char *string, size_t size) {
 }
 
 /* Selects device D, waiting for it to become ready, and then
-   writes SEC_NO to the disk's sector selection registers.  (We
-   use LBA mode.) */
+   writes SEC_NO and the count CNT of sectors to transfer to the
+   disk's sector selection registers.  (We use LBA mode.) */
 static void
-select_sector (struct disk *d, disk_sector_t sec_no) {
+select_sector (struct disk *d, disk_sector_t sec_no, size_t cnt) {
 	struct channel *c = d->channel;
 
-	ASSERT (sec_no < d->capacity);
-	ASSERT (sec_no < (1UL << 28));
+	ASSERT (cnt >= 1 && cnt <= MULTIPLE_MAX);
+	ASSERT (sec_no + cnt <= d->capacity);
+	ASSERT (sec_no + cnt <= (1UL << 28));
 
 	select_device_wait (d);
-	outb (reg_nsect (c), 1);
+	outb (reg_nsect (c), cnt % 256);
 	outb (reg_lbal (c), sec_no);
 	outb (reg_lbam (c), sec_no >> 8);
 	outb (reg_lbah (c), (sec_no >> 16));
@@ -1,4 +1,6 @@
 #include "filesys/directory.h"
+#include <dirent.h>
+#include <round.h>
 #include <stdio.h>
 #include <string.h>
 #include <list.h>
@@ -12,6 +14,9 @@ struct dir {
 	off_t pos;                          /* Current position. */
 };
 
+/* Number of entries dir_readdir_batch() reads from disk at once. */
+#define DIR_BATCH_ENTRIES 16
+
 /* A single directory entry. */
 struct dir_entry {
 	disk_sector_t inode_sector;         /* Sector number of header. */
@@ -214,3 +219,58 @@ dir_readdir (struct dir *dir, char name[NAME_MAX + 1]) {
 	}
 	return false;
 }
+
+/* Fills BUFFER, which is SIZE bytes long, with as many packed
+ * `struct dirent' records as fit, one per in-use entry of DIR,
+ * starting at DIR's position and advancing it past the entries
+ * returned.  Entries are read from disk several at a time.
+ * Returns the number of bytes filled in, 0 at the end of the
+ * directory, or -1 if not even one record fits. */
+int
+dir_readdir_batch (struct dir *dir, void *buffer, size_t size) {
+	struct dir_entry entries[DIR_BATCH_ENTRIES];
+	uint8_t *dst = buffer;
+	size_t used = 0;
+
+	for (;;) {
+		off_t bytes = inode_read_at (dir->inode, entries, sizeof entries,
+				dir->pos);
+		size_t cnt = bytes / sizeof *entries;
+		size_t i;
+
+		if (cnt == 0)
+			return used;
+		for (i = 0; i < cnt; i++) {
+			struct dir_entry *e = &entries[i];
+			struct dirent *d;
+			size_t len;
+
+			if (e->in_use) {
+				len = ROUND_UP (sizeof *d + strlen (e->name) + 1,
+						sizeof d->d_ino);
+				if (used + len > size)
+					return used > 0 ? (int) used : -1;
+
+				d = (struct dirent *) (dst + used);
+				d->d_ino = e->inode_sector;
+				d->d_reclen = len;
+				d->d_type = e->inode_sector == ROOT_DIR_SECTOR ? DT_DIR : DT_REG;
+				strlcpy (d->d_name, e->name, NAME_MAX + 1);
+				used += len;
+			}
+			dir->pos += sizeof *e;
+		}
+	}
+}
+
+/* Sets DIR's position to POS bytes from the start. */
+void
+dir_seek (struct dir *dir, off_t pos) {
+	dir->pos = pos;
+}
+
+/* Returns DIR's position. */
+off_t
+dir_tell (struct dir *dir) {
+	return dir->pos;
+}
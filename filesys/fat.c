@@ -3,17 +3,23 @@
 #include "filesys/filesys.h"
 #include "threads/malloc.h"
 #include "threads/synch.h"
+#include <statfs.h>
 #include <stdio.h>
 #include <string.h>
 
 /* Should be less than DISK_SECTOR_SIZE */
 struct fat_boot {
 	unsigned int magic;
-	unsigned int sectors_per_cluster; /* Fixed to 1 */
+	unsigned int sectors_per_cluster; /* 1 to MAX_SECTORS_PER_CLUSTER. */
 	unsigned int total_sectors;
 	unsigned int fat_start;
 	unsigned int fat_sectors; /* Size of FAT in sectors. */
 	unsigned int root_dir_cluster;
+	/* Usage counters, valid only if CLEAN, which is set by
+	 * fat_close() and cleared on disk by fat_open(). */
+	unsigned int free_clusters;
+	unsigned int inode_cnt;
+	unsigned int clean;
 };
 
 /* FAT FS */
@@ -28,8 +34,14 @@ struct fat_fs {
 
 static struct fat_fs *fat_fs;
 
+/* Cluster size used by the next format, set with the -cluster
+ * kernel option.  An existing disk keeps the size recorded in its
+ * boot sector. */
+static unsigned int format_sectors_per_cluster = SECTORS_PER_CLUSTER;
+
 void fat_boot_create (void);
 void fat_fs_init (void);
+static void write_boot (void);
 
 void
 fat_init (void) {
@@ -48,69 +60,105 @@ fat_init (void) {
 	// Extract FAT info
 	if (fat_fs->bs.magic != FAT_MAGIC)
 		fat_boot_create ();
+	if (fat_fs->bs.sectors_per_cluster < 1
+			|| fat_fs->bs.sectors_per_cluster > MAX_SECTORS_PER_CLUSTER)
+		PANIC ("FAT has bad cluster size %u",
+				fat_fs->bs.sectors_per_cluster);
 	fat_fs_init ();
 }
 
-void
+/* Sets the number of sectors per cluster used when formatting to
+ * CNT.  Returns false if CNT is out of range. */
+bool
+fat_set_cluster_size (unsigned int cnt) {
+	if (cnt < 1 || cnt > MAX_SECTORS_PER_CLUSTER)
+		return false;
+	format_sectors_per_cluster = cnt;
+	return true;
+}
+
+/* Returns the number of sectors per cluster. */
+unsigned int
+fat_cluster_size (void) {
+	return fat_fs->bs.sectors_per_cluster;
+}
+
+/* Loads the FAT from disk.
+ * Returns true if the usage counters in the boot sector were
+ * valid.  If they were not, because the file system was not shut
+ * down cleanly, the free cluster count is recomputed from the FAT
+ * and the inode count is 0; the caller must supply it with
+ * fat_count_inodes(). */
+bool
 fat_open (void) {
+	bool counted;
+
 	fat_fs->fat = calloc (fat_fs->fat_length, sizeof (cluster_t));
 	if (fat_fs->fat == NULL)
 		PANIC ("FAT load failed");
 
-	// Load FAT directly from the disk
+	// Load FAT directly from the disk, whole sectors in one transfer
 	uint8_t *buffer = (uint8_t *) fat_fs->fat;
-	off_t bytes_read = 0;
-	off_t bytes_left = sizeof (fat_fs->fat);
 	const off_t fat_size_in_bytes = fat_fs->fat_length * sizeof (cluster_t);
-	for (unsigned i = 0; i < fat_fs->bs.fat_sectors; i++) {
-		bytes_left = fat_size_in_bytes - bytes_read;
-		if (bytes_left >= DISK_SECTOR_SIZE) {
-			disk_read (filesys_disk, fat_fs->bs.fat_start + i,
-			           buffer + bytes_read);
-			bytes_read += DISK_SECTOR_SIZE;
-		} else {
-			uint8_t *bounce = malloc (DISK_SECTOR_SIZE);
-			if (bounce == NULL)
-				PANIC ("FAT load failed");
-			disk_read (filesys_disk, fat_fs->bs.fat_start + i, bounce);
-			memcpy (buffer + bytes_read, bounce, bytes_left);
-			bytes_read += bytes_left;
-			free (bounce);
-		}
+	const size_t full = fat_size_in_bytes / DISK_SECTOR_SIZE;
+	const off_t bytes_left = fat_size_in_bytes % DISK_SECTOR_SIZE;
+	disk_read_multiple (filesys_disk, fat_fs->bs.fat_start, buffer, full);
+	if (bytes_left > 0) {
+		uint8_t *bounce = malloc (DISK_SECTOR_SIZE);
+		if (bounce == NULL)
+			PANIC ("FAT load failed");
+		disk_read (filesys_disk, fat_fs->bs.fat_start + full, bounce);
+		memcpy (buffer + full * DISK_SECTOR_SIZE, bounce, bytes_left);
+		free (bounce);
 	}
+
+	counted = fat_fs->bs.clean;
+	if (!counted) {
+		fat_fs->bs.free_clusters = 0;
+		fat_fs->bs.inode_cnt = 0;
+		for (cluster_t c = 1; c < fat_fs->fat_length; c++)
+			if (fat_fs->fat[c] == 0)
+				fat_fs->bs.free_clusters++;
+	}
+	fat_fs->bs.clean = false;
+	write_boot ();
+	return counted;
 }
 
-void
-fat_close (void) {
-	// Write FAT boot sector
+/* Writes the boot sector to disk. */
+static void
+write_boot (void) {
 	uint8_t *bounce = calloc (1, DISK_SECTOR_SIZE);
 	if (bounce == NULL)
-		PANIC ("FAT close failed");
+		PANIC ("FAT boot sector write failed");
 	memcpy (bounce, &fat_fs->bs, sizeof (fat_fs->bs));
 	disk_write (filesys_disk, FAT_BOOT_SECTOR, bounce);
 	free (bounce);
+}
 
-	// Write FAT directly to the disk
+void
+fat_close (void) {
+	// Write FAT directly to the disk, whole sectors in one transfer
 	uint8_t *buffer = (uint8_t *) fat_fs->fat;
-	off_t bytes_wrote = 0;
-	off_t bytes_left = sizeof (fat_fs->fat);
 	const off_t fat_size_in_bytes = fat_fs->fat_length * sizeof (cluster_t);
-	for (unsigned i = 0; i < fat_fs->bs.fat_sectors; i++) {
-		bytes_left = fat_size_in_bytes - bytes_wrote;
-		if (bytes_left >= DISK_SECTOR_SIZE) {
-			disk_write (filesys_disk, fat_fs->bs.fat_start + i,
-			            buffer + bytes_wrote);
-			bytes_wrote += DISK_SECTOR_SIZE;
-		} else {
-			bounce = calloc (1, DISK_SECTOR_SIZE);
-			if (bounce == NULL)
-				PANIC ("FAT close failed");
-			memcpy (bounce, buffer + bytes_wrote, bytes_left);
-			disk_write (filesys_disk, fat_fs->bs.fat_start + i, bounce);
-			bytes_wrote += bytes_left;
-			free (bounce);
-		}
+	const size_t full = fat_size_in_bytes / DISK_SECTOR_SIZE;
+	const off_t bytes_left = fat_size_in_bytes % DISK_SECTOR_SIZE;
+	disk_write_multiple (filesys_disk, fat_fs->bs.fat_start, buffer, full);
+	if (bytes_left > 0) {
+		uint8_t *bounce = calloc (1, DISK_SECTOR_SIZE);
+		if (bounce == NULL)
+			PANIC ("FAT close failed");
+		memcpy (bounce, buffer + full * DISK_SECTOR_SIZE, bytes_left);
+		disk_write (filesys_disk, fat_fs->bs.fat_start + full, bounce);
+		free (bounce);
 	}
+
+	// Write FAT boot sector last, marking the usage counters valid
+	fat_fs->bs.clean = true;
+	write_boot ();
+
+	free (fat_fs->fat);
+	fat_fs->fat = NULL;
 }
 
 void
@@ -126,23 +174,26 @@ fat_create (void) {
 
 	// Set up ROOT_DIR_CLST
 	fat_put (ROOT_DIR_CLUSTER, EOChain);
+	fat_fs->bs.free_clusters = fat_fs->fat_length - 2;
 
 	// Fill up ROOT_DIR_CLUSTER region with 0
-	uint8_t *buf = calloc (1, DISK_SECTOR_SIZE);
+	uint8_t *buf = calloc (fat_fs->bs.sectors_per_cluster, DISK_SECTOR_SIZE);
 	if (buf == NULL)
 		PANIC ("FAT create failed due to OOM");
-	disk_write (filesys_disk, cluster_to_sector (ROOT_DIR_CLUSTER), buf);
+	disk_write_multiple (filesys_disk, cluster_to_sector (ROOT_DIR_CLUSTER),
+	                     buf, fat_fs->bs.sectors_per_cluster);
 	free (buf);
 }
 
 void
 fat_boot_create (void) {
+	unsigned int spc = format_sectors_per_cluster;
 	unsigned int fat_sectors =
 	    (disk_size (filesys_disk) - 1)
-	    / (DISK_SECTOR_SIZE / sizeof (cluster_t) * SECTORS_PER_CLUSTER + 1) + 1;
+	    / (DISK_SECTOR_SIZE / sizeof (cluster_t) * spc + 1) + 1;
 	fat_fs->bs = (struct fat_boot){
 	    .magic = FAT_MAGIC,
-	    .sectors_per_cluster = SECTORS_PER_CLUSTER,
+	    .sectors_per_cluster = spc,
 	    .total_sectors = disk_size (filesys_disk),
 	    .fat_start = 1,
 	    .fat_sectors = fat_sectors,
@@ -152,7 +203,19 @@ fat_boot_create (void) {
 
 void
 fat_fs_init (void) {
-	/* TODO: Your code goes here. */
+	struct fat_boot *bs = &fat_fs->bs;
+	unsigned int max_length = bs->fat_sectors
+	                          * (DISK_SECTOR_SIZE / sizeof (cluster_t));
+
+	/* Cluster 0 is never allocated, so it can mean "no cluster";
+	 * cluster 1 is the first cluster of the data region. */
+	fat_fs->data_start = bs->fat_start + bs->fat_sectors;
+	fat_fs->fat_length =
+	    (bs->total_sectors - fat_fs->data_start) / bs->sectors_per_cluster + 1;
+	if (fat_fs->fat_length > max_length)
+		fat_fs->fat_length = max_length;
+	fat_fs->last_clst = ROOT_DIR_CLUSTER;
+	lock_init (&fat_fs->write_lock);
 }
 
 /*----------------------------------------------------------------------------*/
@@ -164,30 +227,127 @@ fat_fs_init (void) {
  * Returns 0 if fails to allocate a new cluster. */
 cluster_t
 fat_create_chain (cluster_t clst) {
-	/* TODO: Your code goes here. */
+	cluster_t new_clst = 0;
+	cluster_t c = fat_fs->last_clst;
+
+	lock_acquire (&fat_fs->write_lock);
+	/* Next fit: continue after the last allocated cluster, so that a
+	 * growing chain tends to stay contiguous. */
+	for (unsigned i = 1; i < fat_fs->fat_length; i++) {
+		if (++c >= fat_fs->fat_length)
+			c = 1;
+		if (fat_fs->fat[c] == 0) {
+			new_clst = c;
+			break;
+		}
+	}
+	if (new_clst != 0) {
+		fat_fs->fat[new_clst] = EOChain;
+		if (clst != 0)
+			fat_fs->fat[clst] = new_clst;
+		fat_fs->last_clst = new_clst;
+		fat_fs->bs.free_clusters--;
+	}
+	lock_release (&fat_fs->write_lock);
+	return new_clst;
 }
 
 /* Remove the chain of clusters starting from CLST.
  * If PCLST is 0, assume CLST as the start of the chain. */
 void
 fat_remove_chain (cluster_t clst, cluster_t pclst) {
-	/* TODO: Your code goes here. */
+	lock_acquire (&fat_fs->write_lock);
+	if (pclst != 0)
+		fat_fs->fat[pclst] = EOChain;
+	while (clst != 0 && clst != EOChain) {
+		cluster_t next;
+
+		ASSERT (clst < fat_fs->fat_length);
+		next = fat_fs->fat[clst];
+		fat_fs->fat[clst] = 0;
+		fat_fs->bs.free_clusters++;
+		clst = next;
+	}
+	lock_release (&fat_fs->write_lock);
+}
+
+/* Writes sector IDX of the FAT to disk. */
+static void
+write_fat_sector (size_t idx) {
+	const size_t fat_size_in_bytes = fat_fs->fat_length * sizeof (cluster_t);
+	const size_t ofs = idx * DISK_SECTOR_SIZE;
+	uint8_t *buffer = (uint8_t *) fat_fs->fat + ofs;
+
+	if (ofs + DISK_SECTOR_SIZE <= fat_size_in_bytes)
+		disk_write (filesys_disk, fat_fs->bs.fat_start + idx, buffer);
+	else {
+		uint8_t *bounce = calloc (1, DISK_SECTOR_SIZE);
+		if (bounce == NULL)
+			PANIC ("FAT write failed");
+		memcpy (bounce, buffer, fat_size_in_bytes - ofs);
+		disk_write (filesys_disk, fat_fs->bs.fat_start + idx, bounce);
+		free (bounce);
+	}
+}
+
+/* Writes the FAT sectors holding the entries of the chain starting
+ * at CLST to disk, instead of the whole FAT as fat_close() does. */
+void
+fat_flush_chain (cluster_t clst) {
+	const size_t per_sector = DISK_SECTOR_SIZE / sizeof (cluster_t);
+	size_t last = (size_t) -1;
+
+	lock_acquire (&fat_fs->write_lock);
+	while (clst != 0 && clst != EOChain) {
+		ASSERT (clst < fat_fs->fat_length);
+		if (clst / per_sector != last) {
+			last = clst / per_sector;
+			write_fat_sector (last);
+		}
+		clst = fat_fs->fat[clst];
+	}
+	lock_release (&fat_fs->write_lock);
+}
+
+/* Adds DELTA to the count of inodes in use. */
+void
+fat_count_inodes (int delta) {
+	fat_fs->bs.inode_cnt += delta;
+}
+
+/* Fills in ST from the usage counters, without scanning the FAT. */
+void
+fat_statfs (struct statfs *st) {
+	st->f_bsize = fat_fs->bs.sectors_per_cluster * DISK_SECTOR_SIZE;
+	st->f_blocks = fat_fs->fat_length - 1;
+	st->f_bfree = fat_fs->bs.free_clusters;
+	st->f_files = fat_fs->bs.inode_cnt;
 }
 
 /* Update a value in the FAT table. */
 void
 fat_put (cluster_t clst, cluster_t val) {
-	/* TODO: Your code goes here. */
+	ASSERT (clst != 0 && clst < fat_fs->fat_length);
+	fat_fs->fat[clst] = val;
 }
 
 /* Fetch a value in the FAT table. */
 cluster_t
 fat_get (cluster_t clst) {
-	/* TODO: Your code goes here. */
+	ASSERT (clst != 0 && clst < fat_fs->fat_length);
+	return fat_fs->fat[clst];
 }
 
 /* Covert a cluster # to a sector number. */
 disk_sector_t
 cluster_to_sector (cluster_t clst) {
-	/* TODO: Your code goes here. */
+	ASSERT (clst != 0);
+	return fat_fs->data_start + (clst - 1) * fat_fs->bs.sectors_per_cluster;
+}
+
+/* Converts a sector number to the # of the cluster containing it. */
+cluster_t
+sector_to_cluster (disk_sector_t sector) {
+	ASSERT (sector >= fat_fs->data_start);
+	return (sector - fat_fs->data_start) / fat_fs->bs.sectors_per_cluster + 1;
 }
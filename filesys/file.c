@@ -2,6 +2,8 @@
 #include <debug.h>
 #include "filesys/inode.h"
 #include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/vaddr.h"
 
 /* An open file. */
 struct file {
@@ -110,6 +112,66 @@ file_write_at (struct file *file, const void *buffer, off_t size,
 	return inode_write_at (file->inode, buffer, size, file_ofs);
 }
 
+/* Copies up to SIZE bytes from IN, starting at byte IN_OFS, to
+ * OUT, starting at byte OUT_OFS, through a kernel page, so that the
+ * data never passes through user memory.  The file positions of IN
+ * and OUT are unaffected.
+ * Returns the number of bytes actually copied, which may be less
+ * than SIZE if end of file is reached in IN or OUT cannot be
+ * written, or -1 if both ranges overlap in the same file or no
+ * buffer is available. */
+off_t
+file_copy_range (struct file *in, off_t in_ofs, struct file *out,
+		off_t out_ofs, off_t size) {
+	uint8_t *buffer;
+	off_t copied = 0;
+
+	if (in->inode == out->inode
+			&& in_ofs < out_ofs + size && out_ofs < in_ofs + size)
+		return -1;
+	buffer = palloc_get_page (0);
+	if (buffer == NULL)
+		return -1;
+
+	while (size > 0) {
+		off_t chunk = size < PGSIZE ? size : PGSIZE;
+		off_t n = inode_read_at (in->inode, buffer, chunk, in_ofs);
+		if (n > 0)
+			n = inode_write_at (out->inode, buffer, n, out_ofs);
+		if (n <= 0)
+			break;
+
+		in_ofs += n;
+		out_ofs += n;
+		copied += n;
+		size -= n;
+		if (n < chunk)
+			break;
+	}
+
+	palloc_free_page (buffer);
+	return copied;
+}
+
+/* Reserves space for FILE to grow to OFFSET + LEN bytes without
+ * changing its length.  See inode_fallocate().
+ * Returns false if writes to FILE are denied or no contiguous free
+ * range is large enough. */
+bool
+file_allocate (struct file *file, off_t offset, off_t len) {
+	if (file->deny_write)
+		return false;
+	return inode_fallocate (file->inode, offset, len);
+}
+
+/* Waits until FILE's data, and its metadata too if METADATA is
+ * true, is on disk.  See inode_sync().
+ * Returns true if successful. */
+bool
+file_sync (struct file *file, bool metadata) {
+	return inode_sync (file->inode, metadata);
+}
+
 /* Prevents write operations on FILE's underlying inode
  * until file_allow_write() is called or FILE is closed. */
 void
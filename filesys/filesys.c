@@ -2,16 +2,37 @@
 #include <debug.h>
 #include <stdio.h>
 #include <string.h>
+#include "filesys/fat.h"
 #include "filesys/file.h"
 #include "filesys/free-map.h"
 #include "filesys/inode.h"
 #include "filesys/directory.h"
+#include "filesys/tmpfs.h"
 #include "devices/disk.h"
+#include "devices/timer.h"
 
 /* The disk that contains the file system. */
 struct disk *filesys_disk;
 
+/* Timer ticks taken by do_format(), or -1 if not formatted. */
+static int64_t format_ticks = -1;
+
 static void do_format (void);
+static bool allocate_inode_sector (struct dir *, disk_sector_t *);
+static void release_inode_sector (disk_sector_t);
+static size_t count_inodes (void);
+
+/* If NAME lies in the tmpfs tree, returns the part of NAME within
+ * it; otherwise returns a null pointer. */
+static const char *
+tmpfs_name (const char *name) {
+	size_t len = strlen (TMPFS_MOUNT);
+
+	if (strlen (name) <= len || memcmp (name, TMPFS_MOUNT, len)
+			|| name[len] != '/')
+		return NULL;
+	return name + len + 1;
+}
 
 /* Initializes the file system module.
  * If FORMAT is true, reformats the file system. */
@@ -22,6 +43,7 @@ filesys_init (bool format) {
 		PANIC ("hd0:1 (hdb) not present, file system initialization failed");
 
 	inode_init ();
+	tmpfs_init ();
 
 #ifdef EFILESYS
 	fat_init ();
@@ -29,7 +51,8 @@ filesys_init (bool format) {
 	if (format)
 		do_format ();
 
-	fat_open ();
+	if (!fat_open ())
+		fat_count_inodes (count_inodes ());
 #else
 	/* Original FS */
 	free_map_init ();
@@ -37,7 +60,8 @@ filesys_init (bool format) {
 	if (format)
 		do_format ();
 
-	free_map_open ();
+	if (!free_map_open ())
+		free_map_count_inodes (count_inodes ());
 #endif
 }
 
@@ -45,6 +69,8 @@ filesys_init (bool format) {
  * to disk. */
 void
 filesys_done (void) {
+	inode_flush_all ();
+
 	/* Original FS */
 #ifdef EFILESYS
 	fat_close ();
@@ -53,6 +79,15 @@ filesys_done (void) {
 #endif
 }
 
+/* Prints file system statistics. */
+void
+filesys_print_stats (void) {
+	if (format_ticks >= 0)
+		printf ("Format: %"PRDSNu" sectors in %"PRId64" ticks\n",
+				disk_size (filesys_disk), format_ticks);
+	inode_print_stats ();
+}
+
 /* Creates a file named NAME with the given INITIAL_SIZE.
  * Returns true if successful, false otherwise.
  * Fails if a file named NAME already exists,
@@ -60,13 +95,19 @@ filesys_done (void) {
 bool
 filesys_create (const char *name, off_t initial_size) {
 	disk_sector_t inode_sector = 0;
-	struct dir *dir = dir_open_root ();
-	bool success = (dir != NULL
-			&& free_map_allocate (1, &inode_sector)
+	struct dir *dir;
+	bool success;
+
+	if (tmpfs_name (name) != NULL)
+		return tmpfs_create (tmpfs_name (name), initial_size);
+
+	dir = dir_open_root ();
+	success = (dir != NULL
+			&& allocate_inode_sector (dir, &inode_sector)
 			&& inode_create (inode_sector, initial_size)
 			&& dir_add (dir, name, inode_sector));
 	if (!success && inode_sector != 0)
-		free_map_release (inode_sector, 1);
+		release_inode_sector (inode_sector);
 	dir_close (dir);
 
 	return success;
@@ -76,12 +117,25 @@ filesys_create (const char *name, off_t initial_size) {
  * Returns the new file if successful or a null pointer
  * otherwise.
  * Fails if no file named NAME exists,
- * or if an internal memory allocation fails. */
+ * or if an internal memory allocation fails.
+ * NAME "/" opens the root directory itself, read-only, for
+ * filesys_readdir_batch().  Names under TMPFS_MOUNT are looked up
+ * in tmpfs. */
 struct file *
 filesys_open (const char *name) {
-	struct dir *dir = dir_open_root ();
+	struct dir *dir;
 	struct inode *inode = NULL;
 
+	if (!strcmp (name, "/")) {
+		struct file *file = file_open (inode_open (ROOT_DIR_SECTOR));
+		if (file != NULL)
+			file_deny_write (file);
+		return file;
+	}
+	if (tmpfs_name (name) != NULL)
+		return file_open (tmpfs_open (tmpfs_name (name)));
+
+	dir = dir_open_root ();
 	if (dir != NULL)
 		dir_lookup (dir, name, &inode);
 	dir_close (dir);
@@ -89,27 +143,170 @@ filesys_open (const char *name) {
 	return file_open (inode);
 }
 
+/* Fills BUFFER, SIZE bytes long, with packed `struct dirent'
+ * records for the directory open as FILE, resuming at FILE's
+ * position and advancing it.  Returns the number of bytes filled,
+ * 0 at end of directory, or -1 if FILE is not a directory or BUFFER
+ * cannot hold a single record. */
+int
+filesys_readdir_batch (struct file *file, void *buffer, size_t size) {
+	struct inode *inode = file_get_inode (file);
+	struct dir *dir;
+	int bytes;
+
+	if (inode_get_inumber (inode) != ROOT_DIR_SECTOR)
+		return -1;
+	dir = dir_open (inode_reopen (inode));
+	if (dir == NULL)
+		return -1;
+
+	dir_seek (dir, file_tell (file));
+	bytes = dir_readdir_batch (dir, buffer, size);
+	file_seek (file, dir_tell (dir));
+	dir_close (dir);
+	return bytes;
+}
+
 /* Deletes the file named NAME.
  * Returns true if successful, false on failure.
  * Fails if no file named NAME exists,
  * or if an internal memory allocation fails. */
 bool
 filesys_remove (const char *name) {
+	struct dir *dir;
+	bool success;
+
+	if (tmpfs_name (name) != NULL)
+		return tmpfs_remove (tmpfs_name (name));
+
+	dir = dir_open_root ();
+	success = dir != NULL && dir_remove (dir, name);
+	dir_close (dir);
+
+	return success;
+}
+
+/* Moves the data of the file named NAME toward the start of the
+ * disk, if there is room, to reduce free space fragmentation.
+ * Returns false if no file named NAME exists. */
+bool
+filesys_defrag (const char *name) {
 	struct dir *dir = dir_open_root ();
-	bool success = dir != NULL && dir_remove (dir, name);
+	struct inode *inode = NULL;
+
+	if (dir != NULL)
+		dir_lookup (dir, name, &inode);
 	dir_close (dir);
+	if (inode == NULL)
+		return false;
+
+	inode_relocate (inode);
+	inode_close (inode);
+	return true;
+}
+
+/* Converts the file named NAME to compressed storage.
+ * Returns false if no file named NAME exists or it cannot be
+ * compressed. */
+bool
+filesys_compress (const char *name) {
+	struct dir *dir = dir_open_root ();
+	struct inode *inode = NULL;
+	bool success;
 
+	if (dir != NULL)
+		dir_lookup (dir, name, &inode);
+	dir_close (dir);
+	if (inode == NULL)
+		return false;
+
+	success = inode_compress (inode);
+	inode_close (inode);
 	return success;
 }
 
-/* Formats the file system. */
+/* Returns the free space fragmentation score, from 0 (all free
+ * space contiguous) to 100. */
+int
+filesys_fragmentation (void) {
+#ifdef EFILESYS
+	return 0;
+#else
+	return free_map_fragmentation ();
+#endif
+}
+
+/* Fills in ST with the file system's size and usage.  This reads
+ * counters kept up to date as space and inodes are allocated, so it
+ * takes constant time. */
+void
+filesys_statfs (struct statfs *st) {
+#ifdef EFILESYS
+	fat_statfs (st);
+#else
+	free_map_statfs (st);
+#endif
+}
+
+/* Counts the inodes in use by walking the root directory, when the
+ * usage counters on disk cannot be trusted. */
+static size_t
+count_inodes (void) {
+	struct dir *dir = dir_open_root ();
+	char name[NAME_MAX + 1];
+	size_t cnt = 1;                     /* Root directory. */
+
+#ifndef EFILESYS
+	cnt++;                              /* Free map file. */
+#endif
+	if (dir == NULL)
+		PANIC ("root dir open failed");
+	while (dir_readdir (dir, name))
+		cnt++;
+	dir_close (dir);
+	return cnt;
+}
+
+/* Allocates a sector for a new inode in DIR and stores it into
+ * *SECTORP.  Under EFILESYS the inode takes a cluster of its own;
+ * otherwise it is kept close to DIR's inode. */
+static bool
+allocate_inode_sector (struct dir *dir UNUSED, disk_sector_t *sectorp) {
+#ifdef EFILESYS
+	cluster_t clst = fat_create_chain (0);
+
+	if (clst == 0)
+		return false;
+	*sectorp = cluster_to_sector (clst);
+	return true;
+#else
+	return free_map_allocate_near (1, inode_get_inumber (dir_get_inode (dir)),
+			sectorp);
+#endif
+}
+
+/* Releases SECTOR, allocated by allocate_inode_sector(). */
+static void
+release_inode_sector (disk_sector_t sector) {
+#ifdef EFILESYS
+	fat_remove_chain (sector_to_cluster (sector), 0);
+#else
+	free_map_release (sector, 1);
+#endif
+}
+
+/* Formats the file system, and records how long it took. */
 static void
 do_format (void) {
+	int64_t start = timer_ticks ();
+
 	printf ("Formatting file system...");
 
 #ifdef EFILESYS
 	/* Create FAT and save it to the disk. */
 	fat_create ();
+	if (!dir_create (ROOT_DIR_SECTOR, 16))
+		PANIC ("root directory creation failed");
 	fat_close ();
 #else
 	free_map_create ();
@@ -119,4 +316,5 @@ do_format (void) {
 #endif
 
 	printf ("done.\n");
+	format_ticks = timer_elapsed (start);
 }
@@ -0,0 +1,416 @@
+#include "filesys/free-extent.h"
+#include <debug.h>
+#include "threads/malloc.h"
+
+/* Free extent index.
+ *
+ * Every maximal run of free sectors is one struct extent, linked
+ * into two AVL trees at once:
+ *
+ *   - BY_START orders extents by first sector.  Each node also
+ *     records the largest extent length in its subtree, which
+ *     finds the first extent of at least N sectors at or after a
+ *     given sector in O(log n), and gives the neighbours needed to
+ *     coalesce a released range.
+ *
+ *   - BY_LEN orders extents by (length, start), which finds the
+ *     smallest extent of at least N sectors (best fit) in
+ *     O(log n).
+ *
+ * The caller keeps the index in sync with the free map bitmap.
+ * free-map.c saves the index when the file system is shut down
+ * cleanly and loads it back on the next mount; otherwise it is
+ * rebuilt from the bitmap. */
+
+enum extent_tree {
+	BY_START,                   /* Ordered by start sector. */
+	BY_LEN,                     /* Ordered by length, then start. */
+	TREE_CNT
+};
+
+struct extent {
+	disk_sector_t start;        /* First free sector. */
+	size_t length;              /* Number of free sectors. */
+	size_t max_length;          /* Largest length in BY_START subtree. */
+	struct extent_link {
+		struct extent *left;
+		struct extent *right;
+		int height;
+	} link[TREE_CNT];
+};
+
+static struct extent *roots[TREE_CNT];
+static size_t extent_cnt;
+
+static void link_extent (struct extent *);
+static void unlink_extent (struct extent *);
+static struct extent *floor_extent (disk_sector_t);
+static struct extent *ceil_extent (disk_sector_t);
+
+/* Orders A and B within tree T. */
+static int
+compare (const struct extent *a, const struct extent *b, enum extent_tree t) {
+	if (t == BY_LEN && a->length != b->length)
+		return a->length < b->length ? -1 : 1;
+	if (a->start != b->start)
+		return a->start < b->start ? -1 : 1;
+	return 0;
+}
+
+static int
+height (const struct extent *e, enum extent_tree t) {
+	return e != NULL ? e->link[t].height : 0;
+}
+
+/* Recomputes E's height in tree T, and its subtree maximum if T is
+ * BY_START, from its children. */
+static void
+update (struct extent *e, enum extent_tree t) {
+	struct extent_link *l = &e->link[t];
+	int hl = height (l->left, t);
+	int hr = height (l->right, t);
+
+	l->height = (hl > hr ? hl : hr) + 1;
+	if (t == BY_START) {
+		e->max_length = e->length;
+		if (l->left != NULL && l->left->max_length > e->max_length)
+			e->max_length = l->left->max_length;
+		if (l->right != NULL && l->right->max_length > e->max_length)
+			e->max_length = l->right->max_length;
+	}
+}
+
+static struct extent *
+rotate_right (struct extent *e, enum extent_tree t) {
+	struct extent *l = e->link[t].left;
+
+	e->link[t].left = l->link[t].right;
+	l->link[t].right = e;
+	update (e, t);
+	update (l, t);
+	return l;
+}
+
+static struct extent *
+rotate_left (struct extent *e, enum extent_tree t) {
+	struct extent *r = e->link[t].right;
+
+	e->link[t].right = r->link[t].left;
+	r->link[t].left = e;
+	update (e, t);
+	update (r, t);
+	return r;
+}
+
+/* Restores the AVL property at E in tree T and returns the new
+ * root of E's subtree. */
+static struct extent *
+rebalance (struct extent *e, enum extent_tree t) {
+	struct extent_link *l = &e->link[t];
+	int balance;
+
+	update (e, t);
+	balance = height (l->left, t) - height (l->right, t);
+	if (balance > 1) {
+		if (height (l->left->link[t].left, t)
+				< height (l->left->link[t].right, t))
+			l->left = rotate_left (l->left, t);
+		return rotate_right (e, t);
+	}
+	if (balance < -1) {
+		if (height (l->right->link[t].right, t)
+				< height (l->right->link[t].left, t))
+			l->right = rotate_right (l->right, t);
+		return rotate_left (e, t);
+	}
+	return e;
+}
+
+static struct extent *
+insert (struct extent *root, struct extent *e, enum extent_tree t) {
+	if (root == NULL) {
+		e->link[t].left = e->link[t].right = NULL;
+		update (e, t);
+		return e;
+	}
+	if (compare (e, root, t) < 0)
+		root->link[t].left = insert (root->link[t].left, e, t);
+	else
+		root->link[t].right = insert (root->link[t].right, e, t);
+	return rebalance (root, t);
+}
+
+/* Detaches the leftmost node of ROOT into *MIN and returns the new
+ * root. */
+static struct extent *
+remove_min (struct extent *root, struct extent **min, enum extent_tree t) {
+	if (root->link[t].left == NULL) {
+		*min = root;
+		return root->link[t].right;
+	}
+	root->link[t].left = remove_min (root->link[t].left, min, t);
+	return rebalance (root, t);
+}
+
+static struct extent *
+erase (struct extent *root, struct extent *e, enum extent_tree t) {
+	int cmp;
+
+	ASSERT (root != NULL);
+	cmp = compare (e, root, t);
+	if (cmp < 0)
+		root->link[t].left = erase (root->link[t].left, e, t);
+	else if (cmp > 0)
+		root->link[t].right = erase (root->link[t].right, e, t);
+	else {
+		struct extent *left = root->link[t].left;
+		struct extent *right = root->link[t].right;
+		struct extent *min;
+
+		if (right == NULL)
+			return left;
+		right = remove_min (right, &min, t);
+		min->link[t].left = left;
+		min->link[t].right = right;
+		return rebalance (min, t);
+	}
+	return rebalance (root, t);
+}
+
+static void
+link_extent (struct extent *e) {
+	enum extent_tree t;
+
+	for (t = 0; t < TREE_CNT; t++)
+		roots[t] = insert (roots[t], e, t);
+}
+
+static void
+unlink_extent (struct extent *e) {
+	enum extent_tree t;
+
+	for (t = 0; t < TREE_CNT; t++)
+		roots[t] = erase (roots[t], e, t);
+}
+
+/* Returns the extent with the greatest start not after SECTOR, or
+ * a null pointer. */
+static struct extent *
+floor_extent (disk_sector_t sector) {
+	struct extent *e = roots[BY_START];
+	struct extent *best = NULL;
+
+	while (e != NULL)
+		if (e->start <= sector) {
+			best = e;
+			e = e->link[BY_START].right;
+		} else
+			e = e->link[BY_START].left;
+	return best;
+}
+
+/* Returns the extent with the least start after SECTOR, or a null
+ * pointer. */
+static struct extent *
+ceil_extent (disk_sector_t sector) {
+	struct extent *e = roots[BY_START];
+	struct extent *best = NULL;
+
+	while (e != NULL)
+		if (e->start > sector) {
+			best = e;
+			e = e->link[BY_START].left;
+		} else
+			e = e->link[BY_START].right;
+	return best;
+}
+
+/* Returns the extent with the least start not before SECTOR whose
+ * length is at least CNT, searching the BY_START subtree E. */
+static struct extent *
+first_fit (struct extent *e, disk_sector_t sector, size_t cnt) {
+	if (e == NULL || e->max_length < cnt)
+		return NULL;
+	if (e->start >= sector) {
+		struct extent *found = first_fit (e->link[BY_START].left, sector, cnt);
+		if (found != NULL)
+			return found;
+		if (e->length >= cnt)
+			return e;
+	}
+	return first_fit (e->link[BY_START].right, sector, cnt);
+}
+
+static void
+destroy (struct extent *e) {
+	if (e != NULL) {
+		destroy (e->link[BY_START].left);
+		destroy (e->link[BY_START].right);
+		free (e);
+	}
+}
+
+/* Removes every extent from the index. */
+void
+free_extent_clear (void) {
+	destroy (roots[BY_START]);
+	roots[BY_START] = roots[BY_LEN] = NULL;
+	extent_cnt = 0;
+}
+
+/* Adds the CNT sectors starting at START, which must not overlap
+ * any free extent, to the index, merging with adjacent extents. */
+void
+free_extent_add (disk_sector_t start, size_t cnt) {
+	struct extent *prev, *next;
+	bool join_prev, join_next;
+
+	if (cnt == 0)
+		return;
+
+	prev = floor_extent (start);
+	next = ceil_extent (start);
+	ASSERT (prev == NULL || prev->start + prev->length <= start);
+	ASSERT (next == NULL || start + cnt <= next->start);
+	join_prev = prev != NULL && prev->start + prev->length == start;
+	join_next = next != NULL && start + cnt == next->start;
+
+	if (join_prev && join_next) {
+		unlink_extent (prev);
+		unlink_extent (next);
+		prev->length += cnt + next->length;
+		free (next);
+		extent_cnt--;
+		link_extent (prev);
+	} else if (join_prev) {
+		unlink_extent (prev);
+		prev->length += cnt;
+		link_extent (prev);
+	} else if (join_next) {
+		unlink_extent (next);
+		next->start = start;
+		next->length += cnt;
+		link_extent (next);
+	} else {
+		struct extent *e = malloc (sizeof *e);
+		if (e == NULL)
+			PANIC ("out of memory for free extent");
+		e->start = start;
+		e->length = cnt;
+		extent_cnt++;
+		link_extent (e);
+	}
+}
+
+/* Removes the CNT sectors starting at START, which must lie within
+ * a single free extent, from the index.
+ * Returns false, leaving the index unchanged, if memory for
+ * splitting the extent is not available. */
+bool
+free_extent_remove (disk_sector_t start, size_t cnt) {
+	struct extent *e = floor_extent (start);
+	disk_sector_t end = start + cnt;
+	disk_sector_t e_end;
+	struct extent *tail = NULL;
+
+	if (cnt == 0)
+		return true;
+
+	ASSERT (e != NULL && end <= e->start + e->length);
+	e_end = e->start + e->length;
+	if (e->start < start && end < e_end) {
+		tail = malloc (sizeof *tail);
+		if (tail == NULL)
+			return false;
+	}
+
+	unlink_extent (e);
+	if (e->start < start) {
+		e->length = start - e->start;
+		link_extent (e);
+		if (tail != NULL) {
+			tail->start = end;
+			tail->length = e_end - end;
+			extent_cnt++;
+			link_extent (tail);
+		}
+	} else if (end < e_end) {
+		e->start = end;
+		e->length = e_end - end;
+		link_extent (e);
+	} else {
+		free (e);
+		extent_cnt--;
+	}
+	return true;
+}
+
+/* Finds CNT free sectors at or after GOAL, wrapping to the start of
+ * the disk if none follow it, and stores the first into *SECTORP.
+ * If GOAL lies inside a large enough extent, *SECTORP is GOAL
+ * itself.  Returns false if no extent is long enough. */
+bool
+free_extent_find_from (size_t cnt, disk_sector_t goal,
+		disk_sector_t *sectorp) {
+	struct extent *e = floor_extent (goal);
+
+	if (e != NULL && e->start + e->length >= goal + cnt) {
+		*sectorp = goal;
+		return true;
+	}
+	e = first_fit (roots[BY_START], goal, cnt);
+	if (e == NULL)
+		e = first_fit (roots[BY_START], 0, cnt);
+	if (e == NULL)
+		return false;
+	*sectorp = e->start;
+	return true;
+}
+
+/* Finds the shortest extent of at least CNT sectors, the lowest one
+ * among equals, and stores its first sector into *SECTORP.
+ * Returns false if no extent is long enough. */
+bool
+free_extent_find_best (size_t cnt, disk_sector_t *sectorp) {
+	struct extent *e = roots[BY_LEN];
+	struct extent *best = NULL;
+
+	while (e != NULL)
+		if (e->length >= cnt) {
+			best = e;
+			e = e->link[BY_LEN].left;
+		} else
+			e = e->link[BY_LEN].right;
+	if (best == NULL)
+		return false;
+	*sectorp = best->start;
+	return true;
+}
+
+/* Stores into *STARTP and *CNTP the free extent with the least start
+ * not before SECTOR.  Returns false if there is none. */
+bool
+free_extent_next (disk_sector_t sector, disk_sector_t *startp,
+		size_t *cntp) {
+	struct extent *e = floor_extent (sector);
+
+	if (e == NULL || e->start != sector)
+		e = ceil_extent (sector);
+	if (e == NULL)
+		return false;
+	*startp = e->start;
+	*cntp = e->length;
+	return true;
+}
+
+/* Returns the number of free extents. */
+size_t
+free_extent_count (void) {
+	return extent_cnt;
+}
+
+/* Returns the length of the longest free extent. */
+size_t
+free_extent_largest (void) {
+	return roots[BY_START] != NULL ? roots[BY_START]->max_length : 0;
+}
@@ -1,12 +1,78 @@
 #include "filesys/free-map.h"
 #include <bitmap.h>
 #include <debug.h>
+#include <statfs.h>
+#include <string.h>
 #include "filesys/file.h"
 #include "filesys/filesys.h"
+#include "filesys/free-extent.h"
 #include "filesys/inode.h"
 
 static struct file *free_map_file;   /* Free map file. */
 static struct bitmap *free_map;      /* Free map, one bit per disk sector. */
+static size_t free_cnt;              /* Free sectors. */
+static size_t inode_cnt;             /* Inodes in use. */
+
+/* Usage counters, stored in the free map file after the bitmap so
+ * that statfs needs no bitmap scan.  They are kept up to date in
+ * memory and written by free_map_close(); CLEAN is cleared on disk
+ * while the file system is open, so that after a crash they are
+ * recomputed instead of trusted.
+ *
+ * The free extent index is saved the same way: free_map_close()
+ * writes up to SAVED_EXTENT_MAX extents after the header, and a
+ * clean mount loads them instead of rebuilding the index from the
+ * bitmap.  A more fragmented disk is not saved and is rebuilt. */
+struct free_map_header {
+	unsigned magic;                  /* FREE_MAP_MAGIC. */
+	uint32_t free_cnt;               /* Free sectors. */
+	uint32_t inode_cnt;              /* Inodes in use. */
+	uint32_t clean;                  /* Counters valid? */
+	uint32_t extent_cnt;             /* Saved extents, or NO_EXTENTS. */
+};
+
+/* A saved free extent. */
+struct saved_extent {
+	uint32_t start;                  /* First free sector. */
+	uint32_t cnt;                    /* Number of free sectors. */
+};
+
+#define FREE_MAP_MAGIC 0x46524545
+#define SAVED_EXTENT_MAX (DISK_SECTOR_SIZE / sizeof (struct saved_extent))
+#define NO_EXTENTS UINT32_MAX
+
+static void write_header (bool clean, uint32_t extent_cnt);
+static uint32_t save_extents (void);
+static bool load_extents (uint32_t cnt);
+
+/* Placement policy, set with the -fit kernel option.
+ *
+ * Free space is looked up in the free extent index (free-extent.c)
+ * rather than by scanning the bitmap.  FIT_NEAR takes the first run
+ * at or after the caller's goal sector (e.g. a file's inode or its
+ * parent directory) so that related metadata and data end up close
+ * together; FIT_NEXT continues from the end of the previous
+ * allocation; FIT_BEST takes the shortest run that fits. */
+enum free_map_fit free_map_fit = FIT_NEAR;
+static disk_sector_t next_fit;       /* Where FIT_NEXT resumes. */
+
+static void rebuild_index (void);
+static bool mark_allocated (disk_sector_t sector, size_t cnt);
+
+/* Sets the placement policy from its NAME: "near", "next", or
+ * "best".  Returns false if NAME is not a policy. */
+bool
+free_map_set_fit (const char *name) {
+	if (!strcmp (name, "near"))
+		free_map_fit = FIT_NEAR;
+	else if (!strcmp (name, "next"))
+		free_map_fit = FIT_NEXT;
+	else if (!strcmp (name, "best"))
+		free_map_fit = FIT_BEST;
+	else
+		return false;
+	return true;
+}
 
 /* Initializes the free map. */
 void
@@ -16,6 +82,9 @@ free_map_init (void) {
 		PANIC ("bitmap creation failed--disk is too large");
 	bitmap_mark (free_map, FREE_MAP_SECTOR);
 	bitmap_mark (free_map, ROOT_DIR_SECTOR);
+	free_cnt = bitmap_count (free_map, 0, bitmap_size (free_map), false);
+	inode_cnt = 0;
+	rebuild_index ();
 }
 
 /* Allocates CNT consecutive sectors from the free map and stores
@@ -24,16 +93,90 @@ free_map_init (void) {
  * available. */
 bool
 free_map_allocate (size_t cnt, disk_sector_t *sectorp) {
-	disk_sector_t sector = bitmap_scan_and_flip (free_map, 0, cnt, false);
-	if (sector != BITMAP_ERROR
-			&& free_map_file != NULL
+	return free_map_allocate_near (cnt, 0, sectorp);
+}
+
+/* Allocates CNT consecutive sectors from the free map according to
+ * the placement policy, using GOAL as the preferred location under
+ * FIT_NEAR, and stores the first into *SECTORP.
+ * Returns true if successful, false if no run of CNT free sectors
+ * exists. */
+bool
+free_map_allocate_near (size_t cnt, disk_sector_t goal,
+		disk_sector_t *sectorp) {
+	disk_sector_t sector;
+	bool found;
+
+	if (cnt == 0) {
+		*sectorp = 0;
+		return true;
+	}
+
+	switch (free_map_fit) {
+		case FIT_BEST:
+			found = free_extent_find_best (cnt, &sector);
+			break;
+		case FIT_NEXT:
+			found = free_extent_find_from (cnt, next_fit, &sector);
+			break;
+		default:
+			found = free_extent_find_from (cnt, goal, &sector);
+			break;
+	}
+	if (!found || !free_extent_remove (sector, cnt)
+			|| !mark_allocated (sector, cnt))
+		return false;
+
+	next_fit = sector + cnt;
+	*sectorp = sector;
+	return true;
+}
+
+/* Allocates CNT consecutive sectors from the lowest free extent
+ * that can hold them, ignoring the placement policy, and stores the
+ * first into *SECTORP.
+ * Returns false if no such run starts before LIMIT. */
+bool
+free_map_allocate_below (size_t cnt, disk_sector_t limit,
+		disk_sector_t *sectorp) {
+	disk_sector_t sector;
+
+	if (cnt == 0 || !free_extent_find_from (cnt, 0, &sector)
+			|| sector >= limit || !free_extent_remove (sector, cnt)
+			|| !mark_allocated (sector, cnt))
+		return false;
+
+	*sectorp = sector;
+	return true;
+}
+
+/* Allocates the CNT sectors starting at SECTOR, if all of them are
+ * free.  Returns true if successful. */
+bool
+free_map_allocate_at (disk_sector_t sector, size_t cnt) {
+	if (sector + cnt > bitmap_size (free_map)
+			|| bitmap_any (free_map, sector, cnt)
+			|| !free_extent_remove (sector, cnt))
+		return false;
+	return mark_allocated (sector, cnt);
+}
+
+/* Marks the CNT sectors starting at SECTOR, just removed from the
+ * free extent index, as allocated in the bitmap and writes the
+ * bitmap to disk.  If the write fails, returns the sectors to the
+ * index and returns false. */
+static bool
+mark_allocated (disk_sector_t sector, size_t cnt) {
+	ASSERT (!bitmap_any (free_map, sector, cnt));
+	bitmap_set_multiple (free_map, sector, cnt, true);
+	if (free_map_file != NULL
 			&& !bitmap_write (free_map, free_map_file)) {
 		bitmap_set_multiple (free_map, sector, cnt, false);
-		sector = BITMAP_ERROR;
+		free_extent_add (sector, cnt);
+		return false;
 	}
-	if (sector != BITMAP_ERROR)
-		*sectorp = sector;
-	return sector != BITMAP_ERROR;
+	free_cnt -= cnt;
+	return true;
 }
 
 /* Makes CNT sectors starting at SECTOR available for use. */
@@ -41,37 +184,199 @@ void
 free_map_release (disk_sector_t sector, size_t cnt) {
 	ASSERT (bitmap_all (free_map, sector, cnt));
 	bitmap_set_multiple (free_map, sector, cnt, false);
-	bitmap_write (free_map, free_map_file);
+	free_extent_add (sector, cnt);
+	free_cnt += cnt;
+	if (free_map_file != NULL)
+		bitmap_write (free_map, free_map_file);
+}
+
+/* Returns the free space fragmentation score: the percentage of
+ * free sectors that lie outside the largest free extent.  0 means
+ * all free space is contiguous. */
+int
+free_map_fragmentation (void) {
+	if (free_cnt == 0)
+		return 0;
+	return (free_cnt - free_extent_largest ()) * 100 / free_cnt;
 }
 
-/* Opens the free map file and reads it from disk. */
+/* Adds DELTA to the count of inodes in use. */
 void
+free_map_count_inodes (int delta) {
+	inode_cnt += delta;
+}
+
+/* Fills in ST from the usage counters, without scanning the
+ * bitmap. */
+void
+free_map_statfs (struct statfs *st) {
+	st->f_bsize = DISK_SECTOR_SIZE;
+	st->f_blocks = bitmap_size (free_map);
+	st->f_bfree = free_cnt;
+	st->f_files = inode_cnt;
+}
+
+/* Writes the usage counters to the free map file, marked CLEAN or
+ * not, along with EXTENT_CNT, the number of extents saved after it.
+ * Free maps created before the counters existed have no room for
+ * them, so the write then has no effect. */
+static void
+write_header (bool clean, uint32_t extent_cnt) {
+	struct free_map_header h;
+
+	h.magic = FREE_MAP_MAGIC;
+	h.free_cnt = free_cnt;
+	h.inode_cnt = inode_cnt;
+	h.clean = clean;
+	h.extent_cnt = extent_cnt;
+	file_write_at (free_map_file, &h, sizeof h, bitmap_file_size (free_map));
+}
+
+/* Writes the free extent index to the free map file after the
+ * header.  Returns the number of extents written, or NO_EXTENTS if
+ * there are too many to save or the write fails. */
+static uint32_t
+save_extents (void) {
+	struct saved_extent saved[SAVED_EXTENT_MAX];
+	size_t cnt = free_extent_count ();
+	disk_sector_t sector = 0;
+	size_t i;
+	off_t size;
+
+	if (cnt > SAVED_EXTENT_MAX)
+		return NO_EXTENTS;
+	for (i = 0; i < cnt; i++) {
+		disk_sector_t start;
+		size_t length;
+
+		if (!free_extent_next (sector, &start, &length))
+			PANIC ("free extent index lost an extent");
+		saved[i].start = start;
+		saved[i].cnt = length;
+		sector = start + length;
+	}
+	size = cnt * sizeof *saved;
+	if (file_write_at (free_map_file, saved, size,
+				bitmap_file_size (free_map) + sizeof (struct free_map_header))
+			!= size)
+		return NO_EXTENTS;
+	return cnt;
+}
+
+/* Loads the free extent index from the CNT extents saved in the free
+ * map file.  Returns false, leaving the index to be rebuilt, if they
+ * cannot be read or do not add up to the free sector count. */
+static bool
+load_extents (uint32_t cnt) {
+	struct saved_extent saved[SAVED_EXTENT_MAX];
+	off_t size = cnt * sizeof *saved;
+	size_t total = 0;
+	uint32_t i;
+
+	if (cnt > SAVED_EXTENT_MAX
+			|| file_read_at (free_map_file, saved, size,
+				bitmap_file_size (free_map) + sizeof (struct free_map_header))
+			!= size)
+		return false;
+	for (i = 0; i < cnt; i++) {
+		if (saved[i].cnt == 0
+				|| saved[i].start + saved[i].cnt > bitmap_size (free_map)
+				|| (i > 0 && saved[i].start
+					<= saved[i - 1].start + saved[i - 1].cnt))
+			return false;
+		total += saved[i].cnt;
+	}
+	if (total != free_cnt)
+		return false;
+
+	free_extent_clear ();
+	for (i = 0; i < cnt; i++)
+		free_extent_add (saved[i].start, saved[i].cnt);
+	return true;
+}
+
+/* Rebuilds the free extent index from the bitmap. */
+static void
+rebuild_index (void) {
+	size_t size = bitmap_size (free_map);
+	size_t start = 0;
+
+	free_extent_clear ();
+	while (start < size) {
+		size_t end;
+
+		start = bitmap_scan (free_map, start, 1, false);
+		if (start == BITMAP_ERROR)
+			break;
+		end = bitmap_scan (free_map, start, 1, true);
+		if (end == BITMAP_ERROR)
+			end = size;
+		free_extent_add (start, end - start);
+		start = end;
+	}
+}
+
+/* Opens the free map file and reads it from disk.
+ * Returns true if the usage counters were read as well.  If they
+ * were not, because the file system was not shut down cleanly,
+ * the free sector count is recomputed from the bitmap and the
+ * inode count is 0; the caller must supply it with
+ * free_map_count_inodes(). */
+bool
 free_map_open (void) {
+	struct free_map_header h;
+	bool counted;
+
 	free_map_file = file_open (inode_open (FREE_MAP_SECTOR));
 	if (free_map_file == NULL)
 		PANIC ("can't open free map");
 	if (!bitmap_read (free_map, free_map_file))
 		PANIC ("can't read free map");
+
+	counted = (file_read_at (free_map_file, &h, sizeof h,
+				bitmap_file_size (free_map)) == (off_t) sizeof h
+			&& h.magic == FREE_MAP_MAGIC && h.clean);
+	if (counted) {
+		free_cnt = h.free_cnt;
+		inode_cnt = h.inode_cnt;
+	} else {
+		free_cnt = bitmap_count (free_map, 0, bitmap_size (free_map), false);
+		inode_cnt = 0;
+	}
+	if (!counted || !load_extents (h.extent_cnt))
+		rebuild_index ();
+	write_header (false, NO_EXTENTS);
+	return counted;
 }
 
-/* Writes the free map to disk and closes the free map file. */
+/* Writes the usage counters and the free extent index to disk and
+ * closes the free map file.  The bitmap itself is written on every
+ * change. */
 void
 free_map_close (void) {
+	write_header (true, save_extents ());
 	file_close (free_map_file);
+	free_map_file = NULL;
 }
 
 /* Creates a new free map file on disk and writes the free map to
- * it. */
+ * it.  The file's space is reserved rather than zeroed, since the
+ * bitmap, the header and the saved extents overwrite it before it
+ * is read, so each sector is written once. */
 void
 free_map_create (void) {
 	/* Create inode. */
-	if (!inode_create (FREE_MAP_SECTOR, bitmap_file_size (free_map)))
+	if (!inode_create (FREE_MAP_SECTOR, 0))
 		PANIC ("free map creation failed");
 
 	/* Write bitmap to file. */
 	free_map_file = file_open (inode_open (FREE_MAP_SECTOR));
 	if (free_map_file == NULL)
 		PANIC ("can't open free map");
+	if (!file_allocate (free_map_file, 0, bitmap_file_size (free_map)
+				+ sizeof (struct free_map_header)
+				+ SAVED_EXTENT_MAX * sizeof (struct saved_extent)))
+		PANIC ("free map creation failed");
 	if (!bitmap_write (free_map, free_map_file))
 		PANIC ("can't write free map");
 }
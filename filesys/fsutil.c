@@ -4,6 +4,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "filesys/directory.h"
+#include "filesys/fat.h"
 #include "filesys/file.h"
 #include "filesys/filesys.h"
 #include "devices/disk.h"
@@ -52,6 +53,54 @@ fsutil_cat (char **argv) {
 	file_close (file);
 }
 
+/* Prints the file system's allocation unit. */
+void
+fsutil_fsinfo (char **argv UNUSED) {
+#ifdef EFILESYS
+	unsigned int spc = fat_cluster_size ();
+
+	printf ("File system: FAT\n");
+	printf ("Cluster size: %u sector(s), %u bytes\n",
+			spc, spc * DISK_SECTOR_SIZE);
+#else
+	printf ("File system: free map\n");
+	printf ("Cluster size: 1 sector(s), %d bytes\n", DISK_SECTOR_SIZE);
+#endif
+}
+
+/* Compacts every file in the root directory toward the start of
+ * the disk and reports the fragmentation score before and after. */
+void
+fsutil_defrag (char **argv UNUSED) {
+	struct dir *dir;
+	char name[NAME_MAX + 1];
+	int file_cnt = 0;
+
+	printf ("Defragmenting file system...\n");
+	printf ("Fragmentation score before: %d\n", filesys_fragmentation ());
+	dir = dir_open_root ();
+	if (dir == NULL)
+		PANIC ("root dir open failed");
+	while (dir_readdir (dir, name)) {
+		if (!filesys_defrag (name))
+			PANIC ("%s: defrag failed", name);
+		file_cnt++;
+	}
+	dir_close (dir);
+	printf ("Fragmentation score after: %d (%d files)\n",
+			filesys_fragmentation (), file_cnt);
+}
+
+/* Stores file ARGV[1] compressed from now on. */
+void
+fsutil_compress (char **argv) {
+	const char *file_name = argv[1];
+
+	printf ("Compressing '%s'...\n", file_name);
+	if (!filesys_compress (file_name))
+		PANIC ("%s: compress failed\n", file_name);
+}
+
 /* Deletes file ARGV[1]. */
 void
 fsutil_rm (char **argv) {
@@ -3,20 +3,45 @@
 #include <debug.h>
 #include <round.h>
 #include <string.h>
+#include <stdio.h>
+#include <lz.h>
 #include "filesys/filesys.h"
 #include "filesys/free-map.h"
 #include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
 
 /* Identifies an inode. */
 #define INODE_MAGIC 0x494e4f44
 
+/* Inode flags. */
+#define INODE_COMPRESSED 0x1            /* Data stored in LZ chunks. */
+
+/* A compressed file is divided into chunks of CHUNK_SIZE bytes,
+ * each compressed on its own.  Chunk I keeps the sectors it would
+ * occupy uncompressed, so it is found without any search, but only
+ * its leading sectors are read or written. */
+#define CHUNK_SIZE (16 * 1024)
+#define CHUNK_CNT 240                   /* Chunks in the chunk map. */
+
+/* Memory inodes, which back tmpfs, keep their data in pages
+ * listed in a single page of pointers, and are numbered from
+ * MEMORY_SECTOR up so that they never clash with a disk inode. */
+#define MEMORY_SECTOR 0x80000000
+#define MEMORY_PAGE_CNT (PGSIZE / sizeof (uint8_t *))
+
 /* On-disk inode.
  * Must be exactly DISK_SECTOR_SIZE bytes long. */
 struct inode_disk {
-	disk_sector_t start;                /* First data sector. */
+	disk_sector_t start;                /* First data sector (cluster, FAT). */
 	off_t length;                       /* File size in bytes. */
 	unsigned magic;                     /* Magic number. */
-	uint32_t unused[125];               /* Not used. */
+	uint32_t reserved;                  /* Sectors set aside by fallocate. */
+	uint32_t flags;                     /* INODE_* flags. */
+	uint16_t chunks[CHUNK_CNT];         /* Compressed chunk sizes, 0=raw. */
+	uint32_t unused[3];                 /* Not used. */
 };
 
 /* Returns the number of sectors to allocate for an inode SIZE
@@ -26,6 +51,15 @@ bytes_to_sectors (off_t size) {
 	return DIV_ROUND_UP (size, DISK_SECTOR_SIZE);
 }
 
+/* Returns the number of data sectors allocated to DISK_INODE,
+ * which is more than its length needs if space was reserved with
+ * inode_fallocate(). */
+static size_t
+allocated_sectors (const struct inode_disk *disk_inode) {
+	size_t sectors = bytes_to_sectors (disk_inode->length);
+	return disk_inode->reserved > sectors ? disk_inode->reserved : sectors;
+}
+
 /* In-memory inode. */
 struct inode {
 	struct list_elem elem;              /* Element in inode list. */
@@ -34,8 +68,18 @@ struct inode {
 	bool removed;                       /* True if deleted, false otherwise. */
 	int deny_write_cnt;                 /* 0: writes ok, >0: deny writes. */
 	struct inode_disk data;             /* Inode content. */
+	struct lock chunk_lock;             /* Protects the three below. */
+	uint8_t *chunk;                     /* Uncompressed chunk, or NULL. */
+	size_t chunk_idx;                   /* Index of chunk in CHUNK. */
+	bool chunk_dirty;                   /* CHUNK differs from disk? */
+	uint8_t **pages;                    /* Memory inode data, or NULL. */
 };
 
+/* Compression statistics. */
+static long long compress_in_cnt;       /* Chunk bytes compressed. */
+static long long compress_out_cnt;      /* Bytes they were stored in. */
+static long long compress_saved_cnt;    /* Disk I/O bytes avoided. */
+
 /* Returns the disk sector that contains byte offset POS within
  * INODE.
  * Returns -1 if INODE does not contain data for a byte at offset
@@ -43,12 +87,168 @@ struct inode {
 static disk_sector_t
 byte_to_sector (const struct inode *inode, off_t pos) {
 	ASSERT (inode != NULL);
-	if (pos < inode->data.length)
+	if (pos < inode->data.length) {
+#ifdef EFILESYS
+		/* DATA.START is the first cluster of a FAT chain. */
+		size_t spc = fat_cluster_size ();
+		size_t idx = pos / DISK_SECTOR_SIZE;
+		cluster_t clst = inode->data.start;
+		size_t hops;
+
+		for (hops = idx / spc; hops > 0; hops--)
+			clst = fat_get (clst);
+		return cluster_to_sector (clst) + idx % spc;
+#else
 		return inode->data.start + pos / DISK_SECTOR_SIZE;
-	else
+#endif
+	} else
 		return -1;
 }
 
+static void count_inodes (int delta);
+
+/* Returns how many of the MAX sectors of a file starting at byte
+ * offset POS, which must lie within its length, are consecutive on
+ * disk and so can be moved with one multi-sector transfer. */
+static size_t
+contiguous_sectors (off_t pos UNUSED, size_t max) {
+#ifdef EFILESYS
+	/* Only the sectors of one cluster are known to be adjacent. */
+	size_t spc = fat_cluster_size ();
+	size_t left = spc - (pos / DISK_SECTOR_SIZE) % spc;
+	return max < left ? max : left;
+#else
+	/* Data is one extent. */
+	return max;
+#endif
+}
+
+/* Number of zero sectors data_allocate() writes at once. */
+#define ZERO_BATCH 8
+
+/* Writes zeros to the CNT sectors starting at SECTOR, ZERO_BATCH
+ * at a time. */
+static void
+zero_sectors (disk_sector_t sector, size_t cnt) {
+	static char zeros[ZERO_BATCH * DISK_SECTOR_SIZE];
+
+	while (cnt > 0) {
+		size_t n = cnt < ZERO_BATCH ? cnt : ZERO_BATCH;
+		disk_write_multiple (filesys_disk, sector, zeros, n);
+		sector += n;
+		cnt -= n;
+	}
+}
+
+/* Allocates and zeroes SECTORS sectors of data for the inode in
+ * SECTOR, and stores where they start into *STARTP: the first
+ * sector of a contiguous extent placed right after the inode when
+ * possible, or under EFILESYS the first cluster of a FAT chain
+ * (0 for an empty file).
+ * Returns false if the disk is full. */
+static bool
+data_allocate (disk_sector_t sector UNUSED, size_t sectors,
+		disk_sector_t *startp) {
+#ifdef EFILESYS
+	size_t spc = fat_cluster_size ();
+	size_t clusters = DIV_ROUND_UP (sectors, spc);
+	cluster_t start = 0, clst = 0;
+	size_t i;
+
+	for (i = 0; i < clusters; i++) {
+		clst = fat_create_chain (clst);
+		if (clst == 0) {
+			if (start != 0)
+				fat_remove_chain (start, 0);
+			return false;
+		}
+		if (start == 0)
+			start = clst;
+		zero_sectors (cluster_to_sector (clst), spc);
+	}
+	*startp = start;
+	return true;
+#else
+	if (!free_map_allocate_near (sectors, sector + 1, startp))
+		return false;
+	zero_sectors (*startp, sectors);
+	return true;
+#endif
+}
+
+/* Releases the data of DISK_INODE and the inode's SECTOR. */
+static void
+data_release (disk_sector_t sector, const struct inode_disk *disk_inode) {
+	count_inodes (-1);
+#ifdef EFILESYS
+	fat_remove_chain (sector_to_cluster (sector), 0);
+	if (disk_inode->start != 0)
+		fat_remove_chain (disk_inode->start, 0);
+#else
+	free_map_release (sector, 1);
+	free_map_release (disk_inode->start, allocated_sectors (disk_inode));
+#endif
+}
+
+static void zero_range (struct inode *, off_t start, off_t end);
+static bool chunk_writeback (struct inode *);
+static bool chunk_store (struct inode *, bool *map_changed);
+static void memory_release (struct inode *);
+static off_t memory_read_at (struct inode *, void *, off_t size,
+		off_t offset);
+static off_t memory_write_at (struct inode *, const void *, off_t size,
+		off_t offset);
+static off_t chunk_read_at (struct inode *, void *, off_t size, off_t offset);
+static off_t chunk_write_at (struct inode *, const void *, off_t size,
+		off_t offset);
+
+/* Adds DELTA to the file system's count of inodes in use. */
+static void
+count_inodes (int delta) {
+#ifdef EFILESYS
+	fat_count_inodes (delta);
+#else
+	free_map_count_inodes (delta);
+#endif
+}
+
+/* Returns a sector-sized bounce buffer, to be released with
+ * put_bounce().  The outermost user gets the calling thread's own
+ * buffer, allocated on first use and kept until the thread exits, so
+ * partial-sector reads and writes no longer pay for a malloc()/free()
+ * pair on every call.  A page fault while copying between a bounce
+ * buffer and user memory can read a file again in the same thread,
+ * so a nested user gets a fresh buffer instead.
+ * Returns a null pointer if memory allocation fails. */
+static uint8_t *
+get_bounce (void) {
+	struct thread *t = thread_current ();
+	uint8_t *bounce;
+
+	if (t->fs_bounce_depth == 0) {
+		if (t->fs_bounce == NULL)
+			t->fs_bounce = malloc (DISK_SECTOR_SIZE);
+		bounce = t->fs_bounce;
+	} else
+		bounce = malloc (DISK_SECTOR_SIZE);
+	if (bounce != NULL)
+		t->fs_bounce_depth++;
+	return bounce;
+}
+
+/* Releases BOUNCE, returned by get_bounce().  Does nothing if
+ * BOUNCE is a null pointer. */
+static void
+put_bounce (uint8_t *bounce) {
+	struct thread *t = thread_current ();
+
+	if (bounce == NULL)
+		return;
+	t->fs_bounce_depth--;
+	if (bounce != t->fs_bounce)
+		free (bounce);
+}
+
 /* List of open inodes, so that opening a single inode twice
  * returns the same `struct inode'. */
 static struct list open_inodes;
@@ -80,15 +280,9 @@ inode_create (disk_sector_t sector, off_t length) {
 		size_t sectors = bytes_to_sectors (length);
 		disk_inode->length = length;
 		disk_inode->magic = INODE_MAGIC;
-		if (free_map_allocate (sectors, &disk_inode->start)) {
+		if (data_allocate (sector, sectors, &disk_inode->start)) {
 			disk_write (filesys_disk, sector, disk_inode);
-			if (sectors > 0) {
-				static char zeros[DISK_SECTOR_SIZE];
-				size_t i;
-
-				for (i = 0; i < sectors; i++) 
-					disk_write (filesys_disk, disk_inode->start + i, zeros); 
-			}
+			count_inodes (1);
 			success = true; 
 		} 
 		free (disk_inode);
@@ -125,10 +319,44 @@ inode_open (disk_sector_t sector) {
 	inode->open_cnt = 1;
 	inode->deny_write_cnt = 0;
 	inode->removed = false;
+	lock_init (&inode->chunk_lock);
+	inode->chunk = NULL;
+	inode->chunk_dirty = false;
+	inode->pages = NULL;
 	disk_read (filesys_disk, inode->sector, &inode->data);
 	return inode;
 }
 
+/* Creates an inode with LENGTH bytes of zeros whose data lives in
+ * memory rather than on disk, for tmpfs, and returns it open.  Its
+ * data is freed when it is last closed.
+ * Returns a null pointer if LENGTH is too large or memory
+ * allocation fails. */
+struct inode *
+inode_create_memory (off_t length) {
+	static disk_sector_t next_sector = MEMORY_SECTOR;
+	struct inode *inode;
+
+	ASSERT (length >= 0);
+	if ((size_t) length > MEMORY_PAGE_CNT * PGSIZE)
+		return NULL;
+	inode = calloc (1, sizeof *inode);
+	if (inode == NULL)
+		return NULL;
+	inode->pages = palloc_get_page (PAL_ZERO);
+	if (inode->pages == NULL) {
+		free (inode);
+		return NULL;
+	}
+
+	list_push_front (&open_inodes, &inode->elem);
+	inode->sector = next_sector++;
+	inode->open_cnt = 1;
+	inode->data.length = length;
+	inode->data.magic = INODE_MAGIC;
+	return inode;
+}
+
 /* Reopens and returns INODE. */
 struct inode *
 inode_reopen (struct inode *inode) {
@@ -158,12 +386,14 @@ inode_close (struct inode *inode) {
 		list_remove (&inode->elem);
 
 		/* Deallocate blocks if removed. */
-		if (inode->removed) {
-			free_map_release (inode->sector, 1);
-			free_map_release (inode->data.start,
-					bytes_to_sectors (inode->data.length)); 
-		}
+		if (inode->pages != NULL)
+			memory_release (inode);
+		else if (inode->removed)
+			data_release (inode->sector, &inode->data);
+		else
+			chunk_writeback (inode);
 
+		free (inode->chunk);
 		free (inode); 
 	}
 }
@@ -185,6 +415,11 @@ inode_read_at (struct inode *inode, void *buffer_, off_t size, off_t offset) {
 	off_t bytes_read = 0;
 	uint8_t *bounce = NULL;
 
+	if (inode->pages != NULL)
+		return memory_read_at (inode, buffer_, size, offset);
+	if (inode->data.flags & INODE_COMPRESSED)
+		return chunk_read_at (inode, buffer_, size, offset);
+
 	while (size > 0) {
 		/* Disk sector to read, starting byte offset within sector. */
 		disk_sector_t sector_idx = byte_to_sector (inode, offset);
@@ -201,13 +436,20 @@ inode_read_at (struct inode *inode, void *buffer_, off_t size, off_t offset) {
 			break;
 
 		if (sector_ofs == 0 && chunk_size == DISK_SECTOR_SIZE) {
-			/* Read full sector directly into caller's buffer. */
-			disk_read (filesys_disk, sector_idx, buffer + bytes_read); 
+			/* Read full sectors directly into caller's buffer, as
+			 * many at once as lie together on disk. */
+			off_t left = size < inode_left ? size : inode_left;
+			size_t cnt = contiguous_sectors (offset,
+					left / DISK_SECTOR_SIZE);
+
+			disk_read_multiple (filesys_disk, sector_idx,
+					buffer + bytes_read, cnt);
+			chunk_size = cnt * DISK_SECTOR_SIZE;
 		} else {
 			/* Read sector into bounce buffer, then partially copy
 			 * into caller's buffer. */
 			if (bounce == NULL) {
-				bounce = malloc (DISK_SECTOR_SIZE);
+				bounce = get_bounce ();
 				if (bounce == NULL)
 					break;
 			}
@@ -220,7 +462,7 @@ inode_read_at (struct inode *inode, void *buffer_, off_t size, off_t offset) {
 		offset += chunk_size;
 		bytes_read += chunk_size;
 	}
-	free (bounce);
+	put_bounce (bounce);
 
 	return bytes_read;
 }
@@ -239,6 +481,26 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
 
 	if (inode->deny_write_cnt)
 		return 0;
+	if (inode->pages != NULL)
+		return memory_write_at (inode, buffer_, size, offset);
+	if (inode->data.flags & INODE_COMPRESSED)
+		return chunk_write_at (inode, buffer_, size, offset);
+
+	/* A file with space reserved by inode_fallocate() grows into it.
+	 * Any gap between the old end of file and OFFSET reads as
+	 * zeros, since reserved sectors are not cleared in advance. */
+	if (inode->data.reserved > 0 && offset + size > inode->data.length) {
+		off_t old_length = inode->data.length;
+		off_t capacity = (off_t) inode->data.reserved * DISK_SECTOR_SIZE;
+		off_t end = offset + size < capacity ? offset + size : capacity;
+
+		if (end > old_length) {
+			inode->data.length = end;
+			disk_write (filesys_disk, inode->sector, &inode->data);
+			if (offset > old_length)
+				zero_range (inode, old_length, offset < end ? offset : end);
+		}
+	}
 
 	while (size > 0) {
 		/* Sector to write, starting byte offset within sector. */
@@ -256,12 +518,19 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
 			break;
 
 		if (sector_ofs == 0 && chunk_size == DISK_SECTOR_SIZE) {
-			/* Write full sector directly to disk. */
-			disk_write (filesys_disk, sector_idx, buffer + bytes_written); 
+			/* Write full sectors directly to disk, as many at once
+			 * as lie together on disk. */
+			off_t left = size < inode_left ? size : inode_left;
+			size_t cnt = contiguous_sectors (offset,
+					left / DISK_SECTOR_SIZE);
+
+			disk_write_multiple (filesys_disk, sector_idx,
+					buffer + bytes_written, cnt);
+			chunk_size = cnt * DISK_SECTOR_SIZE;
 		} else {
 			/* We need a bounce buffer. */
 			if (bounce == NULL) {
-				bounce = malloc (DISK_SECTOR_SIZE);
+				bounce = get_bounce ();
 				if (bounce == NULL)
 					break;
 			}
@@ -282,11 +551,26 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
 		offset += chunk_size;
 		bytes_written += chunk_size;
 	}
-	free (bounce);
+	put_bounce (bounce);
 
 	return bytes_written;
 }
 
+/* Writes zeros to bytes START through END - 1 of INODE, which must
+ * lie within its length. */
+static void
+zero_range (struct inode *inode, off_t start, off_t end) {
+	static const uint8_t zeros[DISK_SECTOR_SIZE];
+
+	while (start < end) {
+		off_t chunk = DISK_SECTOR_SIZE - start % DISK_SECTOR_SIZE;
+		if (chunk > end - start)
+			chunk = end - start;
+		inode_write_at (inode, zeros, chunk, start);
+		start += chunk;
+	}
+}
+
 /* Disables writes to INODE.
    May be called at most once per inode opener. */
 	void
@@ -311,3 +595,518 @@ off_t
 inode_length (const struct inode *inode) {
 	return inode->data.length;
 }
+
+/* Moves INODE's data to the lowest free extent that can hold it,
+ * if that lies before its current location, to compact free space
+ * toward the end of the disk.
+ *
+ * The new extent is marked used on disk before any data is copied,
+ * and the old extent is released only after the on-disk inode,
+ * a single sector, has been rewritten to point at the copy.  A
+ * crash at any point therefore leaves the inode referring to a
+ * complete copy of its data; at worst sectors are leaked.
+ * Returns true if the data was moved. */
+bool
+inode_relocate (struct inode *inode UNUSED) {
+#ifdef EFILESYS
+	/* Data is chained through the FAT and need not be contiguous. */
+	return false;
+#else
+	size_t sectors = allocated_sectors (&inode->data);
+	disk_sector_t old_start = inode->data.start;
+	disk_sector_t new_start;
+	uint8_t *bounce;
+	size_t i;
+
+	if (sectors == 0 || inode->removed || inode->pages != NULL)
+		return false;
+	bounce = get_bounce ();
+	if (bounce == NULL)
+		return false;
+	if (!free_map_allocate_below (sectors, old_start, &new_start)) {
+		put_bounce (bounce);
+		return false;
+	}
+
+	for (i = 0; i < sectors; i++) {
+		disk_read (filesys_disk, old_start + i, bounce);
+		disk_write (filesys_disk, new_start + i, bounce);
+	}
+	put_bounce (bounce);
+
+	inode->data.start = new_start;
+	disk_write (filesys_disk, inode->sector, &inode->data);
+
+	free_map_release (old_start, sectors);
+	return true;
+#endif
+}
+
+/* Reserves disk space so that INODE can grow to OFFSET + LEN bytes
+ * without further allocation.  The length of INODE is unchanged;
+ * later writes past end of file extend it into the reserved space.
+ * Reserved sectors are not zero-filled.
+ *
+ * The data stays one contiguous extent: the sectors right after it
+ * are claimed if they are free, and otherwise the data is moved to
+ * a free extent large enough for the whole file, in the same
+ * crash-safe order as inode_relocate().  Under EFILESYS clusters
+ * are appended to the file's chain instead, which the FAT's
+ * next-fit allocation keeps contiguous when it can.
+ * Returns false if no large enough free range exists. */
+bool
+inode_fallocate (struct inode *inode, off_t offset, off_t len) {
+	struct inode_disk *data = &inode->data;
+	size_t have = allocated_sectors (data);
+	size_t need = bytes_to_sectors (offset + len);
+
+	if (inode->deny_write_cnt || inode->removed || inode->pages != NULL
+			|| (data->flags & INODE_COMPRESSED))
+		return false;
+	if (need <= have)
+		return true;
+
+#ifdef EFILESYS
+	size_t spc = fat_cluster_size ();
+	size_t have_clusters = DIV_ROUND_UP (have, spc);
+	size_t need_clusters = DIV_ROUND_UP (need, spc);
+	cluster_t last = data->start;
+	cluster_t first_new = 0;
+	cluster_t clst;
+	size_t i;
+
+	for (i = 1; i < have_clusters; i++)
+		last = fat_get (last);
+	clst = last;
+	for (i = have_clusters; i < need_clusters; i++) {
+		clst = fat_create_chain (clst);
+		if (clst == 0) {
+			if (first_new != 0)
+				fat_remove_chain (first_new, last);
+			return false;
+		}
+		if (first_new == 0)
+			first_new = clst;
+	}
+	if (data->start == 0)
+		data->start = first_new;
+#else
+	if (have == 0
+			|| !free_map_allocate_at (data->start + have, need - have)) {
+		disk_sector_t old_start = data->start;
+		disk_sector_t new_start;
+		uint8_t *bounce = get_bounce ();
+		size_t i;
+
+		if (bounce == NULL
+				|| !free_map_allocate_near (need, inode->sector + 1, &new_start)) {
+			put_bounce (bounce);
+			return false;
+		}
+
+		for (i = 0; i < have; i++) {
+			disk_read (filesys_disk, old_start + i, bounce);
+			disk_write (filesys_disk, new_start + i, bounce);
+		}
+		put_bounce (bounce);
+		data->start = new_start;
+		data->reserved = need;
+		disk_write (filesys_disk, inode->sector, data);
+
+		if (have > 0)
+			free_map_release (old_start, have);
+		return true;
+	}
+#endif
+	data->reserved = need;
+	disk_write (filesys_disk, inode->sector, data);
+	return true;
+}
+
+/* Returns the number of bytes of INODE's data in chunk IDX. */
+static size_t
+chunk_length (const struct inode *inode, size_t idx) {
+	off_t left = inode->data.length - (off_t) idx * CHUNK_SIZE;
+	return left < CHUNK_SIZE ? left : CHUNK_SIZE;
+}
+
+/* Reads or writes the first SECTORS sectors of chunk IDX of INODE
+ * from or to BUFFER. */
+static void
+chunk_transfer (struct inode *inode, size_t idx, uint8_t *buffer,
+		size_t sectors, bool write) {
+	off_t pos = (off_t) idx * CHUNK_SIZE;
+	size_t i;
+
+	for (i = 0; i < sectors; i++, pos += DISK_SECTOR_SIZE) {
+		disk_sector_t sector = byte_to_sector (inode, pos);
+		if (write)
+			disk_write (filesys_disk, sector, buffer + i * DISK_SECTOR_SIZE);
+		else
+			disk_read (filesys_disk, sector, buffer + i * DISK_SECTOR_SIZE);
+	}
+}
+
+/* Compresses INODE's cached chunk, if it has been modified, and
+ * writes it back along with the chunk map.
+ * Returns false if memory allocation fails. */
+static bool
+chunk_writeback (struct inode *inode) {
+	bool map_changed;
+
+	if (!chunk_store (inode, &map_changed))
+		return false;
+	if (map_changed)
+		disk_write (filesys_disk, inode->sector, &inode->data);
+	return true;
+}
+
+/* Compresses INODE's cached chunk, if it has been modified, writes
+ * it to disk, and updates its chunk map entry in memory only,
+ * storing into *MAP_CHANGED whether the entry changed.  A chunk that
+ * does not shrink by at least one sector is stored uncompressed.
+ * Returns false if memory allocation fails. */
+static bool
+chunk_store (struct inode *inode, bool *map_changed) {
+	size_t idx = inode->chunk_idx;
+	size_t length, sectors, stored;
+	uint8_t *out;
+	size_t out_len;
+
+	*map_changed = false;
+	if (inode->chunk == NULL || !inode->chunk_dirty)
+		return true;
+
+	out = malloc (LZ_BOUND (CHUNK_SIZE) + LZ_WORK_SIZE);
+	if (out == NULL)
+		return false;
+
+	length = chunk_length (inode, idx);
+	sectors = bytes_to_sectors (length);
+	out_len = lz_compress (inode->chunk, length, out, LZ_BOUND (CHUNK_SIZE),
+			out + LZ_BOUND (CHUNK_SIZE));
+	if (out_len != 0 && bytes_to_sectors (out_len) < sectors) {
+		stored = bytes_to_sectors (out_len);
+		memset (out + out_len, 0, stored * DISK_SECTOR_SIZE - out_len);
+		chunk_transfer (inode, idx, out, stored, true);
+	} else {
+		out_len = 0;
+		stored = sectors;
+		memset (inode->chunk + length, 0, stored * DISK_SECTOR_SIZE - length);
+		chunk_transfer (inode, idx, inode->chunk, stored, true);
+	}
+	free (out);
+
+	compress_in_cnt += length;
+	compress_out_cnt += out_len != 0 ? out_len : length;
+	compress_saved_cnt += (sectors - stored) * DISK_SECTOR_SIZE;
+	if (inode->data.chunks[idx] != out_len) {
+		inode->data.chunks[idx] = out_len;
+		*map_changed = true;
+	}
+	inode->chunk_dirty = false;
+	return true;
+}
+
+/* Makes chunk IDX of INODE the cached chunk, writing back the one
+ * it replaces and decompressing IDX from disk.
+ * Returns false if memory allocation fails or the chunk is
+ * corrupt. */
+static bool
+chunk_load (struct inode *inode, size_t idx) {
+	size_t length, sectors;
+	size_t stored_len;
+
+	if (inode->chunk == NULL) {
+		inode->chunk = malloc (CHUNK_SIZE);
+		if (inode->chunk == NULL)
+			return false;
+	} else if (inode->chunk_idx == idx)
+		return true;
+	else if (!chunk_writeback (inode))
+		return false;
+
+	length = chunk_length (inode, idx);
+	sectors = bytes_to_sectors (length);
+	stored_len = inode->data.chunks[idx];
+	if (stored_len == 0)
+		chunk_transfer (inode, idx, inode->chunk, sectors, false);
+	else {
+		size_t stored = bytes_to_sectors (stored_len);
+		uint8_t *in = malloc (stored * DISK_SECTOR_SIZE);
+		size_t n;
+
+		if (in == NULL)
+			return false;
+		chunk_transfer (inode, idx, in, stored, false);
+		n = lz_decompress (in, stored_len, inode->chunk, CHUNK_SIZE);
+		free (in);
+		if (n != length) {
+			inode->chunk_idx = (size_t) -1;
+			return false;
+		}
+		compress_saved_cnt += (sectors - stored) * DISK_SECTOR_SIZE;
+	}
+	inode->chunk_idx = idx;
+	inode->chunk_dirty = false;
+	return true;
+}
+
+/* inode_read_at() for a compressed INODE.
+ *
+ * BUFFER may be user memory, and a page fault on it can read a file,
+ * even this one, and replace the cached chunk.  So data is copied
+ * out of the chunk under CHUNK_LOCK into a bounce buffer, a sector
+ * at a time, and only then into BUFFER with the lock released. */
+static off_t
+chunk_read_at (struct inode *inode, void *buffer_, off_t size,
+		off_t offset) {
+	uint8_t *buffer = buffer_;
+	off_t bytes_read = 0;
+	uint8_t *bounce = get_bounce ();
+
+	if (bounce == NULL)
+		return 0;
+	while (size > 0 && offset < inode->data.length) {
+		size_t idx = offset / CHUNK_SIZE;
+		size_t ofs = offset % CHUNK_SIZE;
+		off_t left = chunk_length (inode, idx) - ofs;
+		off_t n = size < left ? size : left;
+		bool loaded;
+
+		if (n > DISK_SECTOR_SIZE)
+			n = DISK_SECTOR_SIZE;
+		lock_acquire (&inode->chunk_lock);
+		loaded = chunk_load (inode, idx);
+		if (loaded)
+			memcpy (bounce, inode->chunk + ofs, n);
+		lock_release (&inode->chunk_lock);
+		if (!loaded)
+			break;
+		memcpy (buffer + bytes_read, bounce, n);
+		size -= n;
+		offset += n;
+		bytes_read += n;
+	}
+	put_bounce (bounce);
+	return bytes_read;
+}
+
+/* inode_write_at() for a compressed INODE.  The data reaches disk
+ * when the chunk is written back, i.e. when another chunk is
+ * needed or INODE is closed.  Compressed files do not grow.
+ * Like chunk_read_at(), copies through a bounce buffer so that
+ * BUFFER is never touched with CHUNK_LOCK held. */
+static off_t
+chunk_write_at (struct inode *inode, const void *buffer_, off_t size,
+		off_t offset) {
+	const uint8_t *buffer = buffer_;
+	off_t bytes_written = 0;
+	uint8_t *bounce = get_bounce ();
+
+	if (bounce == NULL)
+		return 0;
+	while (size > 0 && offset < inode->data.length) {
+		size_t idx = offset / CHUNK_SIZE;
+		size_t ofs = offset % CHUNK_SIZE;
+		off_t left = chunk_length (inode, idx) - ofs;
+		off_t n = size < left ? size : left;
+		bool loaded;
+
+		if (n > DISK_SECTOR_SIZE)
+			n = DISK_SECTOR_SIZE;
+		memcpy (bounce, buffer + bytes_written, n);
+		lock_acquire (&inode->chunk_lock);
+		loaded = chunk_load (inode, idx);
+		if (loaded) {
+			memcpy (inode->chunk + ofs, bounce, n);
+			inode->chunk_dirty = true;
+		}
+		lock_release (&inode->chunk_lock);
+		if (!loaded)
+			break;
+		size -= n;
+		offset += n;
+		bytes_written += n;
+	}
+	put_bounce (bounce);
+	return bytes_written;
+}
+
+/* Converts INODE to compressed storage, compressing its data one
+ * chunk at a time.  Space reserved by inode_fallocate() stays
+ * allocated, but the file no longer grows into it.
+ * Returns false if INODE is already compressed, is too large for
+ * the chunk map, or memory allocation fails. */
+bool
+inode_compress (struct inode *inode) {
+	struct inode_disk *data = &inode->data;
+	size_t chunk_cnt = DIV_ROUND_UP (data->length, CHUNK_SIZE);
+	size_t idx;
+
+	if ((data->flags & INODE_COMPRESSED) || inode->deny_write_cnt
+			|| inode->removed || inode->pages != NULL || chunk_cnt > CHUNK_CNT)
+		return false;
+
+	/* Every chunk map entry is 0 until now, so chunk_load() reads
+	 * the chunks as they are.  The map entries are kept in memory
+	 * until every chunk's data is on disk, and then written with
+	 * the flag in one inode write, so that the on-disk inode never
+	 * has map entries without the flag that gives them meaning. */
+	lock_acquire (&inode->chunk_lock);
+	for (idx = 0; idx < chunk_cnt; idx++) {
+		bool map_changed;
+
+		if (!chunk_load (inode, idx)) {
+			lock_release (&inode->chunk_lock);
+			return false;
+		}
+		inode->chunk_dirty = true;
+		if (!chunk_store (inode, &map_changed)) {
+			lock_release (&inode->chunk_lock);
+			return false;
+		}
+	}
+	data->flags |= INODE_COMPRESSED;
+	disk_write (filesys_disk, inode->sector, data);
+	lock_release (&inode->chunk_lock);
+	return true;
+}
+
+/* Makes INODE's data durable: writes back its cached chunk, if
+ * any, and then, if METADATA is true, the on-disk inode and the
+ * allocation map entries describing its data, so that nothing on
+ * disk points at data not yet written.  Other inodes' dirty data
+ * is left alone.  Every write has completed when this returns.
+ * Returns false if the cached chunk could not be written back. */
+bool
+inode_sync (struct inode *inode, bool metadata) {
+	bool success;
+
+	if (inode->pages != NULL)
+		return true;
+	lock_acquire (&inode->chunk_lock);
+	success = chunk_writeback (inode);
+	lock_release (&inode->chunk_lock);
+	if (!success)
+		return false;
+	if (metadata) {
+		disk_write (filesys_disk, inode->sector, &inode->data);
+#ifdef EFILESYS
+		fat_flush_chain (sector_to_cluster (inode->sector));
+		fat_flush_chain (inode->data.start);
+#endif
+	}
+	return true;
+}
+
+/* Orders open inodes by their first data sector. */
+static bool
+inode_data_less (const struct list_elem *a_, const struct list_elem *b_,
+		void *aux UNUSED) {
+	const struct inode *a = list_entry (a_, struct inode, elem);
+	const struct inode *b = list_entry (b_, struct inode, elem);
+
+	return a->data.start < b->data.start;
+}
+
+/* Writes back every open inode's cached data, in order of disk
+ * location so that the writes sweep across the disk once. */
+void
+inode_flush_all (void) {
+	struct list_elem *e;
+
+	list_sort (&open_inodes, inode_data_less, NULL);
+	for (e = list_begin (&open_inodes); e != list_end (&open_inodes);
+			e = list_next (e)) {
+		struct inode *inode = list_entry (e, struct inode, elem);
+		if (inode->pages == NULL && !inode->removed) {
+			lock_acquire (&inode->chunk_lock);
+			chunk_writeback (inode);
+			lock_release (&inode->chunk_lock);
+		}
+	}
+}
+
+/* Prints compression statistics. */
+void
+inode_print_stats (void) {
+	if (compress_in_cnt == 0)
+		return;
+	printf ("Compression: %lld bytes stored in %lld (%lld.%02lld:1), "
+			"%lld bytes of disk I/O saved\n",
+			compress_in_cnt, compress_out_cnt,
+			compress_in_cnt / compress_out_cnt,
+			compress_in_cnt * 100 / compress_out_cnt % 100,
+			compress_saved_cnt);
+}
+
+/* Frees the data pages of memory inode INODE. */
+static void
+memory_release (struct inode *inode) {
+	size_t i;
+
+	for (i = 0; i < MEMORY_PAGE_CNT; i++)
+		if (inode->pages[i] != NULL)
+			palloc_free_page (inode->pages[i]);
+	palloc_free_page (inode->pages);
+}
+
+/* inode_read_at() for a memory INODE.  Pages never written read
+ * as zeros. */
+static off_t
+memory_read_at (struct inode *inode, void *buffer_, off_t size,
+		off_t offset) {
+	uint8_t *buffer = buffer_;
+	off_t bytes_read = 0;
+
+	while (size > 0 && offset < inode->data.length) {
+		uint8_t *page = inode->pages[offset / PGSIZE];
+		size_t ofs = offset % PGSIZE;
+		off_t left = inode->data.length - offset;
+		off_t n = PGSIZE - ofs;
+
+		if (n > left)
+			n = left;
+		if (n > size)
+			n = size;
+		if (page != NULL)
+			memcpy (buffer + bytes_read, page + ofs, n);
+		else
+			memset (buffer + bytes_read, 0, n);
+		size -= n;
+		offset += n;
+		bytes_read += n;
+	}
+	return bytes_read;
+}
+
+/* inode_write_at() for a memory INODE, which grows as needed up
+ * to MEMORY_PAGE_CNT pages. */
+static off_t
+memory_write_at (struct inode *inode, const void *buffer_, off_t size,
+		off_t offset) {
+	const uint8_t *buffer = buffer_;
+	off_t bytes_written = 0;
+
+	while (size > 0 && (size_t) offset / PGSIZE < MEMORY_PAGE_CNT) {
+		uint8_t **page = &inode->pages[offset / PGSIZE];
+		size_t ofs = offset % PGSIZE;
+		off_t n = PGSIZE - ofs;
+
+		if (n > size)
+			n = size;
+		if (*page == NULL) {
+			*page = palloc_get_page (PAL_ZERO);
+			if (*page == NULL)
+				break;
+		}
+		memcpy (*page + ofs, buffer + bytes_written, n);
+		size -= n;
+		offset += n;
+		bytes_written += n;
+		if (offset > inode->data.length)
+			inode->data.length = offset;
+	}
+	return bytes_written;
+}
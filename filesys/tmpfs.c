@@ -0,0 +1,108 @@
+#include "filesys/tmpfs.h"
+#include <list.h>
+#include <string.h>
+#include "filesys/directory.h"
+#include "filesys/inode.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+
+/* Memory-backed file system.
+ *
+ * Files created under TMPFS_MOUNT are memory inodes (see
+ * inode_create_memory()), so reading and writing them never
+ * reaches the disk.  The directory is a list in memory as well,
+ * and everything in it is lost at shutdown. */
+
+/* A tmpfs directory entry. */
+struct tmpfs_entry {
+	struct list_elem elem;              /* Element in entry list. */
+	char name[NAME_MAX + 1];            /* Null terminated file name. */
+	struct inode *inode;                /* File, kept open by the entry. */
+};
+
+static struct list entries;
+static struct lock tmpfs_lock;
+
+/* Initializes tmpfs with an empty directory. */
+void
+tmpfs_init (void) {
+	list_init (&entries);
+	lock_init (&tmpfs_lock);
+}
+
+/* Returns the entry named NAME, or a null pointer. */
+static struct tmpfs_entry *
+lookup (const char *name) {
+	struct list_elem *e;
+
+	for (e = list_begin (&entries); e != list_end (&entries); e = list_next (e)) {
+		struct tmpfs_entry *entry = list_entry (e, struct tmpfs_entry, elem);
+		if (!strcmp (entry->name, name))
+			return entry;
+	}
+	return NULL;
+}
+
+/* Creates a file named NAME with the given INITIAL_SIZE.
+ * Returns true if successful, false if NAME is invalid or in use,
+ * or if memory allocation fails. */
+bool
+tmpfs_create (const char *name, off_t initial_size) {
+	struct tmpfs_entry *entry = NULL;
+	bool success = false;
+
+	if (*name == '\0' || strchr (name, '/') != NULL
+			|| strlen (name) > NAME_MAX)
+		return false;
+
+	lock_acquire (&tmpfs_lock);
+	if (lookup (name) == NULL) {
+		entry = malloc (sizeof *entry);
+		if (entry != NULL) {
+			entry->inode = inode_create_memory (initial_size);
+			if (entry->inode != NULL) {
+				strlcpy (entry->name, name, sizeof entry->name);
+				list_push_back (&entries, &entry->elem);
+				success = true;
+			} else
+				free (entry);
+		}
+	}
+	lock_release (&tmpfs_lock);
+	return success;
+}
+
+/* Opens the file named NAME and returns its inode, or a null
+ * pointer if there is none. */
+struct inode *
+tmpfs_open (const char *name) {
+	struct tmpfs_entry *entry;
+	struct inode *inode = NULL;
+
+	lock_acquire (&tmpfs_lock);
+	entry = lookup (name);
+	if (entry != NULL)
+		inode = inode_reopen (entry->inode);
+	lock_release (&tmpfs_lock);
+	return inode;
+}
+
+/* Removes the file named NAME.  Its data is freed once it is no
+ * longer open.  Returns false if there is no such file. */
+bool
+tmpfs_remove (const char *name) {
+	struct tmpfs_entry *entry;
+
+	lock_acquire (&tmpfs_lock);
+	entry = lookup (name);
+	if (entry != NULL)
+		list_remove (&entry->elem);
+	lock_release (&tmpfs_lock);
+	if (entry == NULL)
+		return false;
+
+	inode_remove (entry->inode);
+	inode_close (entry->inode);
+	free (entry);
+	return true;
+}
@@ -2,19 +2,37 @@
 #define FILESYS_FILESYS_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include "filesys/off_t.h"
+#ifdef EFILESYS
+#include "filesys/fat.h"
+#endif
 
 /* Sectors of system file inodes. */
 #define FREE_MAP_SECTOR 0       /* Free map file inode sector. */
+#ifdef EFILESYS
+/* Root directory file inode sector. */
+#define ROOT_DIR_SECTOR (cluster_to_sector (ROOT_DIR_CLUSTER))
+#else
 #define ROOT_DIR_SECTOR 1       /* Root directory file inode sector. */
+#endif
 
 /* Disk used for file system. */
 extern struct disk *filesys_disk;
 
+struct file;
+struct statfs;
+
 void filesys_init (bool format);
 void filesys_done (void);
+void filesys_print_stats (void);
 bool filesys_create (const char *name, off_t initial_size);
 struct file *filesys_open (const char *name);
 bool filesys_remove (const char *name);
+int filesys_readdir_batch (struct file *, void *buffer, size_t size);
+bool filesys_defrag (const char *name);
+int filesys_fragmentation (void);
+bool filesys_compress (const char *name);
+void filesys_statfs (struct statfs *);
 
 #endif /* filesys/filesys.h */
@@ -0,0 +1,24 @@
+#ifndef FILESYS_FREE_EXTENT_H
+#define FILESYS_FREE_EXTENT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "devices/disk.h"
+
+/* In-memory index of free extents, i.e. maximal runs of free
+ * sectors.  See free-extent.c. */
+
+void free_extent_clear (void);
+void free_extent_add (disk_sector_t start, size_t cnt);
+bool free_extent_remove (disk_sector_t start, size_t cnt);
+
+bool free_extent_find_from (size_t cnt, disk_sector_t goal,
+		disk_sector_t *sectorp);
+bool free_extent_find_best (size_t cnt, disk_sector_t *sectorp);
+bool free_extent_next (disk_sector_t sector, disk_sector_t *startp,
+		size_t *cntp);
+
+size_t free_extent_count (void);
+size_t free_extent_largest (void);
+
+#endif /* filesys/free-extent.h */
@@ -5,13 +5,31 @@
 #include <stddef.h>
 #include "devices/disk.h"
 
+struct statfs;
+
+/* Free space placement policies. */
+enum free_map_fit {
+	FIT_NEAR,       /* First fit at or after a goal sector. */
+	FIT_NEXT,       /* First fit after the previous allocation. */
+	FIT_BEST        /* Smallest free extent that fits. */
+};
+
+extern enum free_map_fit free_map_fit;
+bool free_map_set_fit (const char *name);
+
 void free_map_init (void);
 void free_map_read (void);
 void free_map_create (void);
-void free_map_open (void);
+bool free_map_open (void);
 void free_map_close (void);
 
 bool free_map_allocate (size_t, disk_sector_t *);
+bool free_map_allocate_near (size_t, disk_sector_t goal, disk_sector_t *);
+bool free_map_allocate_at (disk_sector_t, size_t);
+bool free_map_allocate_below (size_t, disk_sector_t limit, disk_sector_t *);
 void free_map_release (disk_sector_t, size_t);
+int free_map_fragmentation (void);
+void free_map_count_inodes (int delta);
+void free_map_statfs (struct statfs *);
 
 #endif /* filesys/free-map.h */
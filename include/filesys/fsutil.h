@@ -6,5 +6,8 @@ void fsutil_cat (char **argv);
 void fsutil_rm (char **argv);
 void fsutil_put (char **argv);
 void fsutil_get (char **argv);
+void fsutil_defrag (char **argv);
+void fsutil_fsinfo (char **argv);
+void fsutil_compress (char **argv);
 
 #endif /* filesys/fsutil.h */
@@ -9,6 +9,7 @@ struct bitmap;
 
 void inode_init (void);
 bool inode_create (disk_sector_t, off_t);
+struct inode *inode_create_memory (off_t length);
 struct inode *inode_open (disk_sector_t);
 struct inode *inode_reopen (struct inode *);
 disk_sector_t inode_get_inumber (const struct inode *);
@@ -19,5 +20,11 @@ off_t inode_write_at (struct inode *, const void *, off_t size, off_t offset);
 void inode_deny_write (struct inode *);
 void inode_allow_write (struct inode *);
 off_t inode_length (const struct inode *);
+bool inode_relocate (struct inode *);
+bool inode_fallocate (struct inode *, off_t offset, off_t len);
+bool inode_compress (struct inode *);
+bool inode_sync (struct inode *, bool metadata);
+void inode_flush_all (void);
+void inode_print_stats (void);
 
 #endif /* filesys/inode.h */
@@ -0,0 +1,17 @@
+#ifndef FILESYS_TMPFS_H
+#define FILESYS_TMPFS_H
+
+#include <stdbool.h>
+#include "filesys/off_t.h"
+
+/* Path under which the tmpfs tree is mounted. */
+#define TMPFS_MOUNT "/tmp"
+
+struct inode;
+
+void tmpfs_init (void);
+bool tmpfs_create (const char *name, off_t initial_size);
+struct inode *tmpfs_open (const char *name);
+bool tmpfs_remove (const char *name);
+
+#endif /* filesys/tmpfs.h */
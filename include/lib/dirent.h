@@ -0,0 +1,20 @@
+#ifndef __LIB_DIRENT_H
+#define __LIB_DIRENT_H
+
+#include <stdint.h>
+
+/* One record filled in by readdir_batch().  Records are packed
+ * back to back: each starts D_RECLEN bytes after the previous one
+ * and ends with its null-terminated name. */
+struct dirent {
+	uint32_t d_ino;             /* Inode number (sector). */
+	uint16_t d_reclen;          /* Length of this record in bytes. */
+	uint8_t d_type;             /* DT_REG or DT_DIR. */
+	char d_name[];              /* Null-terminated file name. */
+};
+
+/* Values for d_type. */
+#define DT_REG 1                /* Ordinary file. */
+#define DT_DIR 2                /* Directory. */
+
+#endif /* lib/dirent.h */
@@ -0,0 +1,53 @@
+#ifndef __LIB_IO_RING_H
+#define __LIB_IO_RING_H
+
+#include <stdint.h>
+
+/* Submission/completion rings shared between a user process and
+ * the kernel, for batching file operations into one system call.
+ *
+ * The process fills in io_sqe entries at sq_tail and advances it,
+ * then calls io_ring_enter().  The kernel consumes entries from
+ * sq_head, carries them out in order, and posts one io_cqe per
+ * entry at cq_tail.  The process reads completions from cq_head and
+ * advances it.  Indexes only ever increase; an entry's slot is its
+ * index modulo IO_RING_ENTRIES. */
+
+#define IO_RING_ENTRIES 32          /* Slots per ring; a power of 2. */
+
+/* Operations. */
+enum io_ring_op {
+	IO_RING_NOP,                    /* Do nothing; res is 0. */
+	IO_RING_READ,                   /* read() or pread(). */
+	IO_RING_WRITE,                  /* write() or pwrite(). */
+	IO_RING_OPEN,                   /* open(); ADDR is the file name. */
+	IO_RING_CLOSE                   /* close(). */
+};
+
+/* Submission queue entry. */
+struct io_sqe {
+	uint8_t opcode;                 /* An enum io_ring_op. */
+	int32_t fd;                     /* File descriptor. */
+	uint64_t addr;                  /* Buffer or file name. */
+	uint32_t len;                   /* Buffer length. */
+	int32_t offset;                 /* File offset, or -1 for the position. */
+	uint64_t user_data;             /* Passed back in the completion. */
+};
+
+/* Completion queue entry. */
+struct io_cqe {
+	uint64_t user_data;             /* From the submission. */
+	int32_t res;                    /* Return value of the operation. */
+};
+
+/* A ring pair, registered with io_ring_setup(). */
+struct io_ring {
+	uint32_t sq_head;               /* Next entry the kernel consumes. */
+	uint32_t sq_tail;               /* Next entry the process fills. */
+	uint32_t cq_head;               /* Next completion the process reads. */
+	uint32_t cq_tail;               /* Next completion the kernel posts. */
+	struct io_sqe sq[IO_RING_ENTRIES];
+	struct io_cqe cq[IO_RING_ENTRIES];
+};
+
+#endif /* lib/io_ring.h */
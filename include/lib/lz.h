@@ -0,0 +1,20 @@
+#ifndef __LIB_LZ_H
+#define __LIB_LZ_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Largest input lz_compress() accepts: match offsets are 16 bits. */
+#define LZ_MAX_INPUT 65535
+
+/* Bytes of scratch memory lz_compress() needs. */
+#define LZ_WORK_SIZE (4096 * sizeof (uint16_t))
+
+/* Output buffer size that always holds N compressed bytes. */
+#define LZ_BOUND(N) ((N) + (N) / 255 + 16)
+
+size_t lz_compress (const void *src, size_t n, void *dst, size_t cap,
+		void *work);
+size_t lz_decompress (const void *src, size_t n, void *dst, size_t cap);
+
+#endif /* lib/lz.h */
@@ -0,0 +1,8 @@
+#ifndef __LIB_MMAN_H
+#define __LIB_MMAN_H
+
+/* Flags for mmap_flags(). */
+#define MAP_POPULATE 0x1        /* Load the whole mapping at map time. */
+#define MAP_LOCKED 0x2          /* Load and pin the whole mapping. */
+
+#endif /* lib/mman.h */
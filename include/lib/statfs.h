@@ -0,0 +1,14 @@
+#ifndef __LIB_STATFS_H
+#define __LIB_STATFS_H
+
+#include <stdint.h>
+
+/* File system usage, filled in by statfs(). */
+struct statfs {
+	uint32_t f_bsize;           /* Allocation unit in bytes. */
+	uint32_t f_blocks;          /* Allocation units in the file system. */
+	uint32_t f_bfree;           /* Free allocation units. */
+	uint32_t f_files;           /* Inodes in use. */
+};
+
+#endif /* lib/statfs.h */
@@ -36,6 +36,27 @@ enum {
 
 	SYS_MOUNT,
 	SYS_UMOUNT,
+
+	/* File system maintenance. */
+	SYS_DEFRAG,                 /* Compact a file's data. */
+
+	/* Positioned and vectored I/O. */
+	SYS_PREAD,                  /* Read from a file at an offset. */
+	SYS_PWRITE,                 /* Write to a file at an offset. */
+	SYS_READV,                  /* Read from a file into several buffers. */
+	SYS_WRITEV,                 /* Write to a file from several buffers. */
+	SYS_COPY_FILE_RANGE,        /* Copy data between files in the kernel. */
+	SYS_FALLOCATE,              /* Reserve contiguous space for a file. */
+	SYS_READDIR_BATCH,          /* Read many directory entries at once. */
+	SYS_IO_RING_SETUP,          /* Register a submission/completion ring. */
+	SYS_IO_RING_ENTER,          /* Carry out queued ring operations. */
+
+	/* Synchronized I/O. */
+	SYS_FSYNC,                  /* Write a file's data and metadata. */
+	SYS_FDATASYNC,              /* Write a file's data. */
+
+	/* File system usage. */
+	SYS_STATFS,                 /* Report file system usage. */
 };
 
 #endif /* lib/syscall-nr.h */
@@ -0,0 +1,15 @@
+#ifndef __LIB_UIO_H
+#define __LIB_UIO_H
+
+#include <stddef.h>
+
+/* One buffer of a vectored transfer, for readv() and writev(). */
+struct iovec {
+	void *iov_base;             /* Start of the buffer. */
+	size_t iov_len;             /* Length of the buffer in bytes. */
+};
+
+/* Maximum number of buffers in one vectored transfer. */
+#define IOV_MAX 16
+
+#endif /* lib/uio.h */
@@ -4,6 +4,10 @@
 #include <stdbool.h>
 #include <debug.h>
 #include <stddef.h>
+#include <io_ring.h>
+#include <mman.h>
+#include <statfs.h>
+#include <uio.h>
 
 /* Process identifier. */
 typedef int pid_t;
@@ -38,8 +42,23 @@ void close (int fd);
 
 int dup2(int oldfd, int newfd);
 
+int pread (int fd, void *buffer, unsigned length, off_t offset);
+int pwrite (int fd, const void *buffer, unsigned length, off_t offset);
+int readv (int fd, const struct iovec *iov, int iovcnt);
+int writev (int fd, const struct iovec *iov, int iovcnt);
+int copy_file_range (int fd_in, off_t *off_in, int fd_out, off_t *off_out,
+		unsigned length);
+bool fallocate (int fd, off_t offset, off_t len);
+int readdir_batch (int fd, void *buffer, size_t size);
+int io_ring_setup (struct io_ring *ring);
+int io_ring_enter (unsigned to_submit);
+int fsync (int fd);
+int fdatasync (int fd);
+
 /* Project 3 and optionally project 4. */
 void *mmap (void *addr, size_t length, int writable, int fd, off_t offset);
+void *mmap_flags (void *addr, size_t length, int writable, int fd,
+		off_t offset, int flags);
 void munmap (void *addr);
 
 /* Project 4 only. */
@@ -50,6 +69,10 @@ bool isdir (int fd);
 int inumber (int fd);
 int symlink (const char* target, const char* linkpath);
 
+/* File system maintenance. */
+int defrag (const char *file);
+int statfs (struct statfs *buf);
+
 static inline void* get_phys_addr (void *user_addr) {
 	void* pa;
 	asm volatile ("movq %0, %%rax" ::"r"(user_addr));
@@ -118,11 +118,15 @@ struct thread {
 	struct file *running_file;
 	int exit_status;
 
+	void *fs_bounce;                    /* Sector bounce buffer (filesys/inode.c). */
+	int fs_bounce_depth;                /* Bounce buffers in use (filesys/inode.c). */
+
 	
 
 #ifdef USERPROG
 	/* Owned by userprog/process.c. */
 	uint64_t *pml4;                     /* Page map level 4 */
+	struct io_ring *io_ring;            /* Registered ring (userprog/io_ring.c). */
 #endif
 #ifdef VM
 	/* Table for whole virtual memory owned by thread. */
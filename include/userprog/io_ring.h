@@ -0,0 +1,9 @@
+#ifndef USERPROG_IO_RING_H
+#define USERPROG_IO_RING_H
+
+#include <io_ring.h>
+
+int io_ring_setup (struct io_ring *ring);
+int io_ring_enter (unsigned to_submit);
+
+#endif /* userprog/io_ring.h */
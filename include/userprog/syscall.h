@@ -2,7 +2,10 @@
 #define USERPROG_SYSCALL_H
 
 #include <stdbool.h>
+#include <statfs.h>
+#include <uio.h>
 #include "threads/thread.h"
+#include "filesys/off_t.h"
 
 struct lock filesys_lock;
 
@@ -21,13 +24,26 @@ int write (int fd, const void *buffer, unsigned size);
 void seek (int fd, unsigned position);
 unsigned tell (int fd);
 void close (int fd);
+int pread (int fd, void *buffer, unsigned size, off_t offset);
+int pwrite (int fd, const void *buffer, unsigned size, off_t offset);
+int readv (int fd, const struct iovec *iov, int iovcnt);
+int writev (int fd, const struct iovec *iov, int iovcnt);
+int copy_file_range (int fd_in, off_t *off_in, int fd_out, off_t *off_out,
+		unsigned size);
+bool fallocate (int fd, off_t offset, off_t len);
+int readdir_batch (int fd, void *buffer, size_t size);
+int fsync (int fd);
+int fdatasync (int fd);
+int defrag (const char *file);
+int statfs (struct statfs *buf);
 void check_address (void *addr);
 
 #endif /* userprog/syscall.h */
 
 #ifdef VM
 
-void *mmap(void *addr, size_t length, int writable, int fd, off_t offset);
+void *mmap(void *addr, size_t length, int writable, int fd, off_t offset,
+		int flags);
 void munmap(void *addr);
 
 #endif
\ No newline at end of file
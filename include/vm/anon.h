@@ -4,13 +4,21 @@
 struct page;
 enum vm_type;
 
+/* Most pages anon_swap_out_batch() writes in one transfer. */
+#define SWAP_BATCH_MAX 8
+
 struct anon_page {
 
     size_t offset;
+    bool staged;        /* 스왑에서 미리 읽어 두었고 아직 매핑 전. */
 
 };
 
 void vm_anon_init (void);
 bool anon_initializer (struct page *page, enum vm_type type, void *kva);
+bool anon_copy_swapped (struct page *page, void *aux);
+void anon_swap_out_batch (struct page *pages[], size_t cnt);
+void anon_unstage (struct page *page);
+void anon_print_stats (void);
 
 #endif
@@ -11,10 +11,12 @@ struct file_page {
 	off_t ofs;						/* 읽어야 할 파일 오프셋 */
 	size_t read_bytes;					/* 가상 페이지에 쓰여져 있는 데이터 크기 */
 	size_t zero_bytes;
+	bool text;						/* 실행 파일의 읽기 전용 코드 페이지 */
 };
 
 void vm_file_init (void);
 bool file_backed_initializer (struct page *page, enum vm_type type, void *kva);
+bool load_file (struct page *page, void *aux);
 void *do_mmap(void *addr, size_t length, int writable,
 		struct file *file, off_t offset);
 void do_munmap (void *va);
@@ -52,6 +52,9 @@ struct page {
 	// 읽기, 쓰기 권한
 	bool writable;
 	int mapped_page_count;
+	uint64_t *pml4;        /* 이 페이지를 매핑하는 페이지 테이블. */
+	struct list_elem share_elem; /* 프레임의 역매핑(sharers) 원소. */
+	bool locked;           /* MAP_LOCKED: 매핑 해제 전까지 고정. */
 
 	/* 타입별 데이터는 union으로 묶입니다.
 	각 함수는 자동으로 현재 union을 감지합니다. */
@@ -71,7 +74,17 @@ struct frame {
 	struct page *page;
 	struct list_elem f_elem;
 	struct thread *th;
-	
+	int pinned;            /* 커널이 사용 중인 고정 횟수.
+	                          0일 때만 축출할 수 있다. */
+	struct list sharers;   /* 역매핑: 이 프레임을 매핑한 페이지들.
+	                          각 페이지의 (pml4, va)로 PTE를 찾는다. */
+	int ref_cnt;           /* sharers의 원소 수. */
+	bool spared;           /* 더러워서 시계 바늘이 한 번 건너뜀. */
+	bool evicting;         /* 축출 중: 페이지를 내보내는 중이다. */
+	struct inode *inode;   /* 코드 페이지 캐시에 있으면 실행 파일의
+	                          inode, 아니면 NULL. */
+	off_t ofs;             /* 코드 페이지의 파일 오프셋. */
+	struct hash_elem text_elem; /* 코드 페이지 캐시 원소. */
 };
 
 /* The function table for page operations.
@@ -113,6 +126,9 @@ bool spt_insert_page (struct supplemental_page_table *spt, struct page *page);
 void spt_remove_page (struct supplemental_page_table *spt, struct page *page);
 
 void vm_init (void);
+bool vm_set_watermarks (const char *value);
+void vm_print_stats (void);
+void vm_idle (void);
 bool vm_try_handle_fault (struct intr_frame *f, void *addr, bool user,
 		bool write, bool not_present);
 
@@ -122,11 +138,19 @@ bool vm_alloc_page_with_initializer (enum vm_type type, void *upage,
 		bool writable, vm_initializer *init, void *aux);
 void vm_dealloc_page (struct page *page);
 bool vm_claim_page (void *va);
+void vm_unmap_zero_page (struct page *page);
+bool vm_pin_range (const void *uaddr, size_t size);
+void vm_unpin_range (const void *uaddr, size_t size);
+bool vm_populate (void *addr, size_t length, bool lock);
+void vm_unlock_page (struct page *page);
 enum vm_type page_get_type (struct page *page);
 
 unsigned page_hash (const struct hash_elem *p_, void *aux);
 bool page_less (const struct hash_elem *a_, const struct hash_elem *b_, void *aux);
 void hash_destructor(struct hash_elem *e, void *aux);
 void vm_free_frame(struct frame *frame);
+int vm_frame_detach (struct page *page, struct frame **framep);
+struct frame *vm_get_spare_frame (void);
+void vm_stage_page (struct frame *frame, struct page *page);
 
 #endif  /* VM_VM_H */
@@ -0,0 +1,187 @@
+#include "lz.h"
+#include <stdbool.h>
+#include <string.h>
+
+/* LZ77 block compressor in the style of LZ4.
+
+   A compressed block is a series of sequences.  Each sequence is
+   a token byte, whose high nibble is a literal count and whose low
+   nibble is a match length minus LZ_MIN_MATCH, followed by:
+
+     - further literal count bytes, if the nibble was 15, each
+       added to the count, ending with the first byte below 255;
+
+     - the literal bytes themselves;
+
+     - a 16-bit little-endian offset back into the output, unless
+       this is the last sequence, which carries literals only;
+
+     - further match length bytes, if the nibble was 15, coded like
+       the literal count.
+
+   Matches are found through a hash table of the last position at
+   which each 4-byte prefix was seen, so compression runs in one
+   pass and decompression is a loop of copies.  See
+   http://en.wikipedia.org/wiki/LZ4_(compression_algorithm). */
+
+#define LZ_MIN_MATCH 4          /* Shortest match worth coding. */
+#define LZ_HASH_BITS 12         /* log2 of hash table entries. */
+
+/* Returns the 4 bytes at P as one word. */
+static inline uint32_t
+read32 (const uint8_t *p) {
+	uint32_t v;
+	memcpy (&v, p, sizeof v);
+	return v;
+}
+
+/* Hashes the 4-byte prefix V into a table index. */
+static inline unsigned
+hash (uint32_t v) {
+	return (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+/* Appends LEN, less the 15 already in a token nibble, to OP as a
+   run of 255s ending in a smaller byte.  Returns the new end. */
+static uint8_t *
+put_length (uint8_t *op, size_t len) {
+	for (; len >= 255; len -= 255)
+		*op++ = 255;
+	*op++ = len;
+	return op;
+}
+
+/* Appends a sequence of LIT_LEN literals from LIT followed by a
+   match of MATCH_LEN bytes OFFSET bytes back, or no match if
+   MATCH_LEN is 0, to OP.  Returns the new end, or a null pointer
+   if the sequence would run past OEND. */
+static uint8_t *
+put_sequence (uint8_t *op, uint8_t *oend, const uint8_t *lit,
+		size_t lit_len, size_t match_len, size_t offset) {
+	size_t ml = match_len > 0 ? match_len - LZ_MIN_MATCH : 0;
+	size_t need = 1 + lit_len / 255 + 1 + lit_len + 2 + ml / 255 + 1;
+
+	if (need > (size_t) (oend - op))
+		return NULL;
+
+	*op++ = (lit_len >= 15 ? 15 : lit_len) << 4 | (ml >= 15 ? 15 : ml);
+	if (lit_len >= 15)
+		op = put_length (op, lit_len - 15);
+	memcpy (op, lit, lit_len);
+	op += lit_len;
+	if (match_len > 0) {
+		*op++ = offset & 0xff;
+		*op++ = offset >> 8;
+		if (ml >= 15)
+			op = put_length (op, ml - 15);
+	}
+	return op;
+}
+
+/* Compresses the N bytes at SRC into the CAP bytes at DST, using
+   the LZ_WORK_SIZE bytes at WORK as scratch space.  N must not
+   exceed LZ_MAX_INPUT.  A CAP of LZ_BOUND(N) always suffices.
+   Returns the compressed size, or 0 if it would exceed CAP. */
+size_t
+lz_compress (const void *src_, size_t n, void *dst_, size_t cap,
+		void *work) {
+	const uint8_t *src = src_;
+	uint8_t *dst = dst_;
+	uint8_t *op = dst;
+	uint8_t *oend = dst + cap;
+	uint16_t *table = work;
+	size_t ip = 0, anchor = 0;
+
+	if (n > LZ_MAX_INPUT)
+		return 0;
+	memset (table, 0, LZ_WORK_SIZE);
+
+	while (ip + LZ_MIN_MATCH <= n) {
+		uint32_t seq = read32 (src + ip);
+		unsigned h = hash (seq);
+		size_t ref = table[h];
+
+		table[h] = ip;
+		if (ref < ip && read32 (src + ref) == seq) {
+			size_t len = LZ_MIN_MATCH;
+
+			while (ip + len < n && src[ref + len] == src[ip + len])
+				len++;
+			op = put_sequence (op, oend, src + anchor, ip - anchor, len,
+					ip - ref);
+			if (op == NULL)
+				return 0;
+			ip += len;
+			anchor = ip;
+		} else
+			ip++;
+	}
+
+	op = put_sequence (op, oend, src + anchor, n - anchor, 0, 0);
+	return op != NULL ? (size_t) (op - dst) : 0;
+}
+
+/* Reads a length continued past a 15 in a token nibble from *IPP,
+   which must stay before IEND, and adds it to *LEN.
+   Returns false if the input ends first. */
+static bool
+get_length (const uint8_t **ipp, const uint8_t *iend, size_t *len) {
+	uint8_t b;
+
+	do {
+		if (*ipp >= iend)
+			return false;
+		b = *(*ipp)++;
+		*len += b;
+	} while (b == 255);
+	return true;
+}
+
+/* Decompresses the N bytes at SRC, produced by lz_compress(), into
+   the CAP bytes at DST.
+   Returns the decompressed size, or 0 if SRC is malformed or its
+   contents do not fit in CAP. */
+size_t
+lz_decompress (const void *src_, size_t n, void *dst_, size_t cap) {
+	const uint8_t *ip = src_;
+	const uint8_t *iend = ip + n;
+	uint8_t *dst = dst_;
+	uint8_t *op = dst;
+	uint8_t *oend = dst + cap;
+
+	while (ip < iend) {
+		uint8_t token = *ip++;
+		size_t lit_len = token >> 4;
+		size_t match_len = token & 15;
+		size_t offset;
+
+		if (lit_len == 15 && !get_length (&ip, iend, &lit_len))
+			return 0;
+		if (lit_len > (size_t) (iend - ip) || lit_len > (size_t) (oend - op))
+			return 0;
+		memcpy (op, ip, lit_len);
+		ip += lit_len;
+		op += lit_len;
+
+		/* The last sequence has no match. */
+		if (ip == iend)
+			break;
+
+		if (iend - ip < 2)
+			return 0;
+		offset = ip[0] | ip[1] << 8;
+		ip += 2;
+		if (offset == 0 || offset > (size_t) (op - dst))
+			return 0;
+		if (match_len == 15 && !get_length (&ip, iend, &match_len))
+			return 0;
+		match_len += LZ_MIN_MATCH;
+		if (match_len > (size_t) (oend - op))
+			return 0;
+
+		/* Byte by byte, since the match may overlap its own output. */
+		for (; match_len > 0; match_len--, op++)
+			*op = op[-offset];
+	}
+	return op - dst;
+}
@@ -54,7 +54,7 @@ static __inline int64_t syscall (uint64_t num_, uint64_t a1_, uint64_t a2_,
 			((uint64_t) ARG2), 0, 0, 0))
 
 #define syscall4(NUMBER, ARG0, ARG1, ARG2, ARG3) ( \
-		syscall(((uint64_t *) NUMBER), \
+		syscall(((uint64_t) NUMBER), \
 			((uint64_t) ARG0), \
 			((uint64_t) ARG1), \
 			((uint64_t) ARG2), \
@@ -68,6 +68,15 @@ static __inline int64_t syscall (uint64_t num_, uint64_t a1_, uint64_t a2_,
 			((uint64_t) ARG3), \
 			((uint64_t) ARG4), \
 			0))
+
+#define syscall6(NUMBER, ARG0, ARG1, ARG2, ARG3, ARG4, ARG5) ( \
+		syscall(((uint64_t) NUMBER), \
+			((uint64_t) ARG0), \
+			((uint64_t) ARG1), \
+			((uint64_t) ARG2), \
+			((uint64_t) ARG3), \
+			((uint64_t) ARG4), \
+			((uint64_t) ARG5)))
 void
 halt (void) {
 	syscall0 (SYS_HALT);
@@ -140,6 +149,62 @@ close (int fd) {
 	syscall1 (SYS_CLOSE, fd);
 }
 
+int
+pread (int fd, void *buffer, unsigned size, off_t offset) {
+	return syscall4 (SYS_PREAD, fd, buffer, size, offset);
+}
+
+int
+pwrite (int fd, const void *buffer, unsigned size, off_t offset) {
+	return syscall4 (SYS_PWRITE, fd, buffer, size, offset);
+}
+
+int
+readv (int fd, const struct iovec *iov, int iovcnt) {
+	return syscall3 (SYS_READV, fd, iov, iovcnt);
+}
+
+int
+writev (int fd, const struct iovec *iov, int iovcnt) {
+	return syscall3 (SYS_WRITEV, fd, iov, iovcnt);
+}
+
+int
+copy_file_range (int fd_in, off_t *off_in, int fd_out, off_t *off_out,
+		unsigned size) {
+	return syscall5 (SYS_COPY_FILE_RANGE, fd_in, off_in, fd_out, off_out, size);
+}
+
+bool
+fallocate (int fd, off_t offset, off_t len) {
+	return syscall3 (SYS_FALLOCATE, fd, offset, len);
+}
+
+int
+readdir_batch (int fd, void *buffer, size_t size) {
+	return syscall3 (SYS_READDIR_BATCH, fd, buffer, size);
+}
+
+int
+io_ring_setup (struct io_ring *ring) {
+	return syscall1 (SYS_IO_RING_SETUP, ring);
+}
+
+int
+io_ring_enter (unsigned to_submit) {
+	return syscall1 (SYS_IO_RING_ENTER, to_submit);
+}
+
+int
+fsync (int fd) {
+	return syscall1 (SYS_FSYNC, fd);
+}
+
+int
+fdatasync (int fd) {
+	return syscall1 (SYS_FDATASYNC, fd);
+}
+
 int
 dup2 (int oldfd, int newfd){
 	return syscall2 (SYS_DUP2, oldfd, newfd);
@@ -150,6 +215,13 @@ mmap (void *addr, size_t length, int writable, int fd, off_t offset) {
 	return (void *) syscall5 (SYS_MMAP, addr, length, writable, fd, offset);
 }
 
+void *
+mmap_flags (void *addr, size_t length, int writable, int fd, off_t offset,
+		int flags) {
+	return (void *) syscall6 (SYS_MMAP, addr, length, writable, fd, offset,
+			flags);
+}
+
 void
 munmap (void *addr) {
 	syscall1 (SYS_MUNMAP, addr);
@@ -194,3 +266,13 @@ int
 umount (const char *path) {
 	return syscall1 (SYS_UMOUNT, path);
 }
+
+int
+defrag (const char *file) {
+	return syscall1 (SYS_DEFRAG, file);
+}
+
+int
+statfs (struct statfs *buf) {
+	return syscall1 (SYS_STATFS, buf);
+}
@@ -0,0 +1,47 @@
+/* Copies a file with copy_file_range(), first using and advancing
+   the file positions and then with explicit offsets, and verifies
+   the result. */
+
+#include <random.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char buf[6000];
+
+void
+test_main (void) 
+{
+  off_t in_ofs, out_ofs;
+  int in, out;
+
+  random_bytes (buf, sizeof buf);
+  CHECK (create ("src", sizeof buf), "create \"src\"");
+  CHECK ((in = open ("src")) > 1, "open \"src\"");
+  CHECK (write (in, buf, sizeof buf) == sizeof buf, "write \"src\"");
+  msg ("seek \"src\" to 0");
+  seek (in, 0);
+
+  CHECK (create ("dst", sizeof buf), "create \"dst\"");
+  CHECK ((out = open ("dst")) > 1, "open \"dst\"");
+  CHECK (copy_file_range (in, NULL, out, NULL, sizeof buf) == sizeof buf,
+         "copy \"src\" to \"dst\"");
+  CHECK (tell (in) == sizeof buf && tell (out) == sizeof buf,
+         "file positions advanced");
+
+  in_ofs = 1000;
+  out_ofs = 0;
+  CHECK (copy_file_range (in, &in_ofs, out, &out_ofs, 100) == 100,
+         "copy 100 bytes at offsets");
+  CHECK (in_ofs == 1100 && out_ofs == 100, "offsets advanced");
+  CHECK (tell (in) == sizeof buf && tell (out) == sizeof buf,
+         "file positions unchanged");
+  memcpy (buf, buf + 1000, 100);
+
+  msg ("close \"src\"");
+  close (in);
+  msg ("close \"dst\"");
+  close (out);
+  check_file ("dst", buf, sizeof buf);
+}
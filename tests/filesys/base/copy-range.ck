@@ -0,0 +1,25 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(copy-range) begin
+(copy-range) create "src"
+(copy-range) open "src"
+(copy-range) write "src"
+(copy-range) seek "src" to 0
+(copy-range) create "dst"
+(copy-range) open "dst"
+(copy-range) copy "src" to "dst"
+(copy-range) file positions advanced
+(copy-range) copy 100 bytes at offsets
+(copy-range) offsets advanced
+(copy-range) file positions unchanged
+(copy-range) close "src"
+(copy-range) close "dst"
+(copy-range) open "dst" for verification
+(copy-range) verified contents of "dst"
+(copy-range) close "dst"
+(copy-range) end
+EOF
+pass;
@@ -0,0 +1,79 @@
+/* cp.c
+
+   Copies a file and reports what the copy cost, to compare copying
+   inside the kernel with a user-space read/write loop.
+
+   Usage: cp [-u] SRC DST
+
+   Without -u the data is moved with copy_file_range(); with -u it
+   goes through a user buffer with read() and write(). */
+
+#include <syscall.h>
+#include <stdio.h>
+#include <string.h>
+
+static char buf[4096];
+
+int
+main (int argc, char *argv[]) 
+{
+  bool user = argc > 1 && !strcmp (argv[1], "-u");
+  const char *src, *dst;
+  long long reads, writes;
+  int in, out, size;
+  int copied = 0, calls = 0;
+
+  if (argc != (user ? 4 : 3))
+    {
+      printf ("usage: cp [-u] SRC DST\n");
+      return EXIT_FAILURE;
+    }
+  src = argv[user ? 2 : 1];
+  dst = argv[user ? 3 : 2];
+
+  in = open (src);
+  if (in < 0)
+    {
+      printf ("%s: open failed\n", src);
+      return EXIT_FAILURE;
+    }
+  size = filesize (in);
+  if (!create (dst, size) || (out = open (dst)) < 0)
+    {
+      printf ("%s: create failed\n", dst);
+      return EXIT_FAILURE;
+    }
+
+  reads = get_fs_disk_read_cnt ();
+  writes = get_fs_disk_write_cnt ();
+  if (user)
+    for (;;)
+      {
+        int n = read (in, buf, sizeof buf);
+        calls++;
+        if (n <= 0)
+          break;
+        calls++;
+        if (write (out, buf, n) != n)
+          break;
+        copied += n;
+      }
+  else
+    while (copied < size)
+      {
+        int n = copy_file_range (in, NULL, out, NULL, size - copied);
+        calls++;
+        if (n <= 0)
+          break;
+        copied += n;
+      }
+  reads = get_fs_disk_read_cnt () - reads;
+  writes = get_fs_disk_write_cnt () - writes;
+
+  printf ("cp: %d of %d bytes, %d system calls, "
+          "%lld disk reads, %lld disk writes\n",
+          copied, size, calls, reads, writes);
+  close (in);
+  close (out);
+  return copied == size ? EXIT_SUCCESS : EXIT_FAILURE;
+}
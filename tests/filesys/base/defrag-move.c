@@ -0,0 +1,38 @@
+/* Removes two files that precede a third one, defragments the
+   third, and verifies that free space did not become more
+   fragmented and that the file's contents survived the move. */
+
+#include <random.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char buf[40960];
+
+void
+test_main (void) 
+{
+  int before, after;
+  int fd;
+
+  CHECK (create ("a", sizeof buf), "create \"a\"");
+  CHECK (create ("b", sizeof buf), "create \"b\"");
+  CHECK (create ("c", sizeof buf), "create \"c\"");
+
+  random_bytes (buf, sizeof buf);
+  CHECK ((fd = open ("c")) > 1, "open \"c\"");
+  CHECK (write (fd, buf, sizeof buf) == sizeof buf, "write \"c\"");
+  msg ("close \"c\"");
+  close (fd);
+
+  CHECK (remove ("a"), "remove \"a\"");
+  CHECK (remove ("b"), "remove \"b\"");
+
+  CHECK ((before = defrag (NULL)) >= 0, "measure fragmentation");
+  CHECK ((after = defrag ("c")) >= 0, "defrag \"c\"");
+  if (after > before)
+    fail ("fragmentation rose from %d to %d", before, after);
+  CHECK (defrag ("a") == -1, "defrag removed \"a\" (must fail)");
+
+  check_file ("c", buf, sizeof buf);
+}
@@ -0,0 +1,23 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(defrag-move) begin
+(defrag-move) create "a"
+(defrag-move) create "b"
+(defrag-move) create "c"
+(defrag-move) open "c"
+(defrag-move) write "c"
+(defrag-move) close "c"
+(defrag-move) remove "a"
+(defrag-move) remove "b"
+(defrag-move) measure fragmentation
+(defrag-move) defrag "c"
+(defrag-move) defrag removed "a" (must fail)
+(defrag-move) open "c" for verification
+(defrag-move) verified contents of "c"
+(defrag-move) close "c"
+(defrag-move) end
+EOF
+pass;
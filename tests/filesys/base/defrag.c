@@ -0,0 +1,23 @@
+/* defrag.c
+
+   Moves the named files toward the start of the disk and reports
+   the free space fragmentation score before and after. */
+
+#include <syscall.h>
+#include <stdio.h>
+
+int
+main (int argc, char *argv[]) 
+{
+  int i;
+
+  printf ("fragmentation before: %d\n", defrag (NULL));
+  for (i = 1; i < argc; i++)
+    if (defrag (argv[i]) < 0)
+      {
+        printf ("%s: no such file\n", argv[i]);
+        return EXIT_FAILURE;
+      }
+  printf ("fragmentation after: %d\n", defrag (NULL));
+  return EXIT_SUCCESS;
+}
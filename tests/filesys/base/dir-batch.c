@@ -0,0 +1,62 @@
+/* Creates a number of files and lists the root directory with
+   readdir_batch(), using a buffer that holds only a few records so
+   that several calls are needed, and checks that every file is
+   listed exactly once. */
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define FILE_CNT 10
+
+static char buf[64];
+
+void
+test_main (void) 
+{
+  int seen[FILE_CNT];
+  char name[16];
+  int calls = 0;
+  int fd, bytes, i;
+
+  for (i = 0; i < FILE_CNT; i++)
+    {
+      snprintf (name, sizeof name, "file%d", i);
+      if (!create (name, 0))
+        fail ("create \"%s\" failed", name);
+      seen[i] = 0;
+    }
+  msg ("create %d files", FILE_CNT);
+
+  CHECK ((fd = open ("/")) > 1, "open \"/\"");
+  while ((bytes = readdir_batch (fd, buf, sizeof buf)) > 0)
+    {
+      int ofs;
+
+      calls++;
+      for (ofs = 0; ofs < bytes; )
+        {
+          struct dirent *d = (struct dirent *) (buf + ofs);
+          int n;
+
+          if (!memcmp (d->d_name, "file", 4)
+              && (n = atoi (d->d_name + 4)) >= 0 && n < FILE_CNT)
+            seen[n]++;
+          ofs += d->d_reclen;
+        }
+    }
+  CHECK (bytes == 0, "read to end of directory");
+  if (calls < 2 || calls > FILE_CNT)
+    fail ("%d calls to list %d files", calls, FILE_CNT);
+  msg ("close \"/\"");
+  close (fd);
+
+  for (i = 0; i < FILE_CNT; i++)
+    if (seen[i] != 1)
+      fail ("file%d listed %d times", i, seen[i]);
+  msg ("every file listed once");
+}
@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(dir-batch) begin
+(dir-batch) create 10 files
+(dir-batch) open "/"
+(dir-batch) read to end of directory
+(dir-batch) close "/"
+(dir-batch) every file listed once
+(dir-batch) end
+EOF
+pass;
@@ -0,0 +1,46 @@
+/* Reserves space for a file with fallocate(), then grows it by
+   appending, and checks that growth stops at the end of the
+   reservation and that an impossible reservation is refused. */
+
+#include <random.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define RESERVE 8192
+
+static char buf[RESERVE];
+
+void
+test_main (void) 
+{
+  size_t ofs;
+  int fd;
+
+  random_bytes (buf, sizeof buf);
+  CHECK (create ("log", 0), "create \"log\"");
+  CHECK ((fd = open ("log")) > 1, "open \"log\"");
+  CHECK (fallocate (fd, 0, RESERVE), "fallocate \"log\"");
+  CHECK (filesize (fd) == 0, "size of \"log\" unchanged");
+
+  for (ofs = 0; ofs < 3000; ofs += 1000)
+    if (write (fd, buf + ofs, 1000) != 1000)
+      fail ("append at offset %zu failed", ofs);
+  msg ("append 3000 bytes to \"log\"");
+  CHECK (filesize (fd) == 3000, "size of \"log\" is 3000");
+
+  msg ("seek \"log\" to %d", RESERVE - 100);
+  seek (fd, RESERVE - 100);
+  CHECK (write (fd, buf + RESERVE - 100, 200) == 100,
+         "write stops at end of reservation");
+  CHECK (filesize (fd) == RESERVE, "size of \"log\" is %d", RESERVE);
+
+  CHECK (!fallocate (fd, 0, 64 * 1024 * 1024),
+         "fallocate larger than disk (must fail)");
+  msg ("close \"log\"");
+  close (fd);
+
+  memset (buf + 3000, 0, RESERVE - 100 - 3000);
+  check_file ("log", buf, sizeof buf);
+}
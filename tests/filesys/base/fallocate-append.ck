@@ -0,0 +1,23 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(fallocate-append) begin
+(fallocate-append) create "log"
+(fallocate-append) open "log"
+(fallocate-append) fallocate "log"
+(fallocate-append) size of "log" unchanged
+(fallocate-append) append 3000 bytes to "log"
+(fallocate-append) size of "log" is 3000
+(fallocate-append) seek "log" to 8092
+(fallocate-append) write stops at end of reservation
+(fallocate-append) size of "log" is 8192
+(fallocate-append) fallocate larger than disk (must fail)
+(fallocate-append) close "log"
+(fallocate-append) open "log" for verification
+(fallocate-append) verified contents of "log"
+(fallocate-append) close "log"
+(fallocate-append) end
+EOF
+pass;
@@ -0,0 +1,29 @@
+/* Writes a file, flushes it with fsync() and fdatasync(), and
+   checks that flushing something other than an open file fails. */
+
+#include <random.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char buf[1500];
+
+void
+test_main (void) 
+{
+  int fd;
+
+  random_bytes (buf, sizeof buf);
+  CHECK (create ("data", sizeof buf), "create \"data\"");
+  CHECK ((fd = open ("data")) > 1, "open \"data\"");
+  CHECK (write (fd, buf, sizeof buf) == sizeof buf, "write \"data\"");
+  CHECK (fsync (fd) == 0, "fsync \"data\"");
+  CHECK (fdatasync (fd) == 0, "fdatasync \"data\"");
+  msg ("close \"data\"");
+  close (fd);
+  check_file ("data", buf, sizeof buf);
+
+  CHECK (fsync (0) == -1, "fsync stdin (must fail)");
+  CHECK (fsync (fd) == -1, "fsync closed fd (must fail)");
+  CHECK (fdatasync (99) == -1, "fdatasync bad fd (must fail)");
+}
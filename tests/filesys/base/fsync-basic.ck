@@ -0,0 +1,21 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(fsync-basic) begin
+(fsync-basic) create "data"
+(fsync-basic) open "data"
+(fsync-basic) write "data"
+(fsync-basic) fsync "data"
+(fsync-basic) fdatasync "data"
+(fsync-basic) close "data"
+(fsync-basic) open "data" for verification
+(fsync-basic) verified contents of "data"
+(fsync-basic) close "data"
+(fsync-basic) fsync stdin (must fail)
+(fsync-basic) fsync closed fd (must fail)
+(fsync-basic) fdatasync bad fd (must fail)
+(fsync-basic) end
+EOF
+pass;
@@ -0,0 +1,66 @@
+/* fsync-bench.c
+
+   Writes a file and reports what durability costs, to compare
+   writing with and without a flush every N writes.
+
+   Usage: fsync-bench [-d] N
+
+   Writes 64 blocks of 512 bytes to a new file "bench", calling
+   fsync() after every N writes, or fdatasync() with -d.  N of 0
+   never flushes. */
+
+#include <syscall.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BLOCK_CNT 64
+
+static char buf[512];
+
+int
+main (int argc, char *argv[]) 
+{
+  bool data_only = argc > 1 && !strcmp (argv[1], "-d");
+  long long writes;
+  int fd, every, i;
+  int calls = 0, synced = 0;
+
+  if (argc != (data_only ? 3 : 2))
+    {
+      printf ("usage: fsync-bench [-d] N\n");
+      return EXIT_FAILURE;
+    }
+  every = atoi (argv[data_only ? 2 : 1]);
+
+  if (!create ("bench", 0) || (fd = open ("bench")) < 0
+      || !fallocate (fd, 0, BLOCK_CNT * sizeof buf))
+    {
+      printf ("bench: create failed\n");
+      return EXIT_FAILURE;
+    }
+  memset (buf, 'x', sizeof buf);
+
+  writes = get_fs_disk_write_cnt ();
+  for (i = 1; i <= BLOCK_CNT; i++)
+    {
+      calls++;
+      if (write (fd, buf, sizeof buf) != sizeof buf)
+        break;
+      if (every > 0 && i % every == 0)
+        {
+          calls++;
+          if ((data_only ? fdatasync (fd) : fsync (fd)) != 0)
+            break;
+          synced++;
+        }
+    }
+  writes = get_fs_disk_write_cnt () - writes;
+
+  printf ("fsync-bench: %d blocks, %d %s calls, %d system calls, "
+          "%lld disk writes\n", i - 1, synced,
+          data_only ? "fdatasync" : "fsync", calls, writes);
+  close (fd);
+  remove ("bench");
+  return i > BLOCK_CNT ? EXIT_SUCCESS : EXIT_FAILURE;
+}
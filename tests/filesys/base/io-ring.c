@@ -0,0 +1,80 @@
+/* Writes a file through an I/O ring, submitting all of the writes
+   with a single io_ring_enter() call, and verifies the
+   completions and the file's contents. */
+
+#include <random.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define CHUNK 512
+#define CHUNK_CNT 8
+
+static struct io_ring ring;
+static char buf[CHUNK * CHUNK_CNT];
+
+/* Queues an operation on RING. */
+static void
+submit (uint8_t opcode, int fd, void *addr, uint32_t len, int32_t offset,
+        uint64_t user_data)
+{
+  struct io_sqe *sqe = &ring.sq[ring.sq_tail % IO_RING_ENTRIES];
+
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->addr = (uint64_t) addr;
+  sqe->len = len;
+  sqe->offset = offset;
+  sqe->user_data = user_data;
+  ring.sq_tail++;
+}
+
+/* Takes the next completion from RING. */
+static struct io_cqe
+reap (void)
+{
+  if (ring.cq_head == ring.cq_tail)
+    fail ("completion ring is empty");
+  return ring.cq[ring.cq_head++ % IO_RING_ENTRIES];
+}
+
+void
+test_main (void) 
+{
+  struct io_cqe cqe;
+  int fd, i;
+
+  random_bytes (buf, sizeof buf);
+  CHECK (create ("data", sizeof buf), "create \"data\"");
+  CHECK (io_ring_setup (&ring) == 0, "set up ring");
+
+  submit (IO_RING_OPEN, 0, "data", 0, -1, 100);
+  CHECK (io_ring_enter (1) == 1, "submit open");
+  cqe = reap ();
+  fd = cqe.res;
+  if (cqe.user_data != 100 || fd < 2)
+    fail ("open completion: user_data %d, res %d", (int) cqe.user_data, fd);
+
+  /* Queue the chunks in reverse order, at explicit offsets. */
+  for (i = CHUNK_CNT - 1; i >= 0; i--)
+    submit (IO_RING_WRITE, fd, buf + i * CHUNK, CHUNK, i * CHUNK, i);
+  CHECK (io_ring_enter (CHUNK_CNT) == CHUNK_CNT,
+         "submit %d writes at once", CHUNK_CNT);
+  for (i = CHUNK_CNT - 1; i >= 0; i--)
+    {
+      cqe = reap ();
+      if (cqe.user_data != (uint64_t) i || cqe.res != CHUNK)
+        fail ("write completion %d: user_data %d, res %d",
+              i, (int) cqe.user_data, cqe.res);
+    }
+  msg ("reap %d write completions", CHUNK_CNT);
+
+  submit (IO_RING_CLOSE, fd, NULL, 0, -1, 200);
+  CHECK (io_ring_enter (1) == 1, "submit close");
+  cqe = reap ();
+  if (cqe.user_data != 200 || cqe.res != 0)
+    fail ("close completion: user_data %d, res %d",
+          (int) cqe.user_data, cqe.res);
+
+  check_file ("data", buf, sizeof buf);
+}
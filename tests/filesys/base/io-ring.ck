@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(io-ring) begin
+(io-ring) create "data"
+(io-ring) set up ring
+(io-ring) submit open
+(io-ring) submit 8 writes at once
+(io-ring) reap 8 write completions
+(io-ring) submit close
+(io-ring) open "data" for verification
+(io-ring) verified contents of "data"
+(io-ring) close "data"
+(io-ring) end
+EOF
+pass;
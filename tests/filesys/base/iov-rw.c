@@ -0,0 +1,65 @@
+/* Writes a file with writev(), reads parts of it back with pread()
+   and readv(), and checks that pread() and pwrite() leave the file
+   position alone. */
+
+#include <random.h>
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char part1[100];
+static char part2[1000];
+static char part3[2000];
+static char buf[sizeof part1 + sizeof part2 + sizeof part3];
+static char expected[sizeof buf];
+
+void
+test_main (void) 
+{
+  struct iovec iov[3] =
+    {
+      {part1, sizeof part1},
+      {part2, sizeof part2},
+      {part3, sizeof part3},
+    };
+  int fd;
+
+  random_bytes (part1, sizeof part1);
+  random_bytes (part2, sizeof part2);
+  random_bytes (part3, sizeof part3);
+
+  CHECK (create ("data", sizeof buf), "create \"data\"");
+  CHECK ((fd = open ("data")) > 1, "open \"data\"");
+  CHECK (writev (fd, iov, 3) == sizeof buf, "writev \"data\"");
+  CHECK (tell (fd) == sizeof buf, "tell \"data\" after writev");
+
+  CHECK (pread (fd, buf, sizeof part2, sizeof part1) == sizeof part2,
+         "pread \"data\"");
+  compare_bytes (buf, part2, sizeof part2, sizeof part1, "data");
+  CHECK (tell (fd) == sizeof buf, "tell \"data\" after pread");
+
+  memset (buf, 0, sizeof part1);
+  CHECK (pwrite (fd, buf, sizeof part1, 0) == sizeof part1,
+         "pwrite \"data\"");
+  CHECK (tell (fd) == sizeof buf, "tell \"data\" after pwrite");
+
+  memset (expected, 0, sizeof part1);
+  memcpy (expected + sizeof part1, part2, sizeof part2);
+  memcpy (expected + sizeof part1 + sizeof part2, part3, sizeof part3);
+
+  msg ("seek \"data\" to 0");
+  seek (fd, 0);
+  memset (part1, 1, sizeof part1);
+  memset (part2, 1, sizeof part2);
+  memset (part3, 1, sizeof part3);
+  CHECK (readv (fd, iov, 3) == sizeof buf, "readv \"data\"");
+  memcpy (buf, part1, sizeof part1);
+  memcpy (buf + sizeof part1, part2, sizeof part2);
+  memcpy (buf + sizeof part1 + sizeof part2, part3, sizeof part3);
+  compare_bytes (buf, expected, sizeof buf, 0, "data");
+  msg ("close \"data\"");
+  close (fd);
+
+  check_file ("data", expected, sizeof expected);
+}
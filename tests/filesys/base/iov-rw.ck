@@ -0,0 +1,23 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(iov-rw) begin
+(iov-rw) create "data"
+(iov-rw) open "data"
+(iov-rw) writev "data"
+(iov-rw) tell "data" after writev
+(iov-rw) pread "data"
+(iov-rw) tell "data" after pread
+(iov-rw) pwrite "data"
+(iov-rw) tell "data" after pwrite
+(iov-rw) seek "data" to 0
+(iov-rw) readv "data"
+(iov-rw) close "data"
+(iov-rw) open "data" for verification
+(iov-rw) verified contents of "data"
+(iov-rw) close "data"
+(iov-rw) end
+EOF
+pass;
@@ -0,0 +1,9 @@
+/* Writes out a fairly large file sequentially, one page-sized,
+   sector-aligned block at a time, then reads it back to verify
+   that it was written properly.  Every block maps onto whole
+   sectors, so the kernel can move the data directly between the
+   disk and the user buffer. */
+
+#define TEST_SIZE 73728
+#define BLOCK_SIZE 4096
+#include "tests/filesys/base/seq-block.inc"
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(lg-seq-aligned) begin
+(lg-seq-aligned) create "noodle"
+(lg-seq-aligned) open "noodle"
+(lg-seq-aligned) writing "noodle"
+(lg-seq-aligned) close "noodle"
+(lg-seq-aligned) open "noodle" for verification
+(lg-seq-aligned) verified contents of "noodle"
+(lg-seq-aligned) close "noodle"
+(lg-seq-aligned) end
+EOF
+pass;
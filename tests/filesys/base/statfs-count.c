@@ -0,0 +1,33 @@
+/* Checks that statfs() reports the space and inode taken by a new
+   file, and their return when it is removed. */
+
+#include <round.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define FILE_SIZE 5000
+
+void
+test_main (void) 
+{
+  struct statfs before, created, removed;
+  unsigned blocks;
+
+  CHECK (statfs (&before) == 0, "statfs");
+  CHECK (before.f_bsize > 0 && before.f_bfree <= before.f_blocks,
+         "counters are sane");
+  CHECK (create ("quux", FILE_SIZE), "create \"quux\"");
+  CHECK (statfs (&created) == 0, "statfs");
+
+  /* One allocation unit for the inode, the rest for the data. */
+  blocks = DIV_ROUND_UP (FILE_SIZE, before.f_bsize) + 1;
+  CHECK (before.f_bfree - created.f_bfree == blocks,
+         "free space dropped by %u blocks", blocks);
+  CHECK (created.f_files == before.f_files + 1, "inode count rose by 1");
+
+  CHECK (remove ("quux"), "remove \"quux\"");
+  CHECK (statfs (&removed) == 0, "statfs");
+  CHECK (removed.f_bfree == before.f_bfree, "free space restored");
+  CHECK (removed.f_files == before.f_files, "inode count restored");
+}
@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(statfs-count) begin
+(statfs-count) statfs
+(statfs-count) counters are sane
+(statfs-count) create "quux"
+(statfs-count) statfs
+(statfs-count) free space dropped by 11 blocks
+(statfs-count) inode count rose by 1
+(statfs-count) remove "quux"
+(statfs-count) statfs
+(statfs-count) free space restored
+(statfs-count) inode count restored
+(statfs-count) end
+EOF
+pass;
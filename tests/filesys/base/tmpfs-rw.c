@@ -0,0 +1,36 @@
+/* Creates, writes, reads back and removes a file under /tmp, and
+   verifies that none of it is written to the file system disk. */
+
+#include <random.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static char buf[6000];
+static char buf2[sizeof buf];
+
+void
+test_main (void) 
+{
+  long long writes;
+  int fd;
+
+  random_bytes (buf, sizeof buf);
+  writes = get_fs_disk_write_cnt ();
+  CHECK (create ("/tmp/scratch", 0), "create \"/tmp/scratch\"");
+  CHECK ((fd = open ("/tmp/scratch")) > 1, "open \"/tmp/scratch\"");
+  CHECK (write (fd, buf, sizeof buf) == sizeof buf, "write \"/tmp/scratch\"");
+  CHECK (filesize (fd) == sizeof buf, "file grew to %zu bytes", sizeof buf);
+  msg ("seek \"/tmp/scratch\" to 0");
+  seek (fd, 0);
+  CHECK (read (fd, buf2, sizeof buf2) == sizeof buf2, "read \"/tmp/scratch\"");
+  compare_bytes (buf2, buf, sizeof buf, 0, "/tmp/scratch");
+  msg ("close \"/tmp/scratch\"");
+  close (fd);
+  check_file ("/tmp/scratch", buf, sizeof buf);
+  CHECK (get_fs_disk_write_cnt () == writes, "no disk writes");
+
+  CHECK (open ("scratch") == -1, "open \"scratch\" on disk (must fail)");
+  CHECK (remove ("/tmp/scratch"), "remove \"/tmp/scratch\"");
+  CHECK (open ("/tmp/scratch") == -1, "open \"/tmp/scratch\" (must fail)");
+}
@@ -0,0 +1,23 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(tmpfs-rw) begin
+(tmpfs-rw) create "/tmp/scratch"
+(tmpfs-rw) open "/tmp/scratch"
+(tmpfs-rw) write "/tmp/scratch"
+(tmpfs-rw) file grew to 6000 bytes
+(tmpfs-rw) seek "/tmp/scratch" to 0
+(tmpfs-rw) read "/tmp/scratch"
+(tmpfs-rw) close "/tmp/scratch"
+(tmpfs-rw) open "/tmp/scratch" for verification
+(tmpfs-rw) verified contents of "/tmp/scratch"
+(tmpfs-rw) close "/tmp/scratch"
+(tmpfs-rw) no disk writes
+(tmpfs-rw) open "scratch" on disk (must fail)
+(tmpfs-rw) remove "/tmp/scratch"
+(tmpfs-rw) open "/tmp/scratch" (must fail)
+(tmpfs-rw) end
+EOF
+pass;
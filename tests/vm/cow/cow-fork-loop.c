@@ -0,0 +1,60 @@
+/* Fork-heavy workload: forks many children from a parent with a
+   large resident data set, and has each child fork a grandchild in
+   turn.  Every process reads all of the data but writes only one
+   page, so with copy-on-write a fork costs little more than the
+   page tables.  Copying or leaking frames at fork would run the
+   machine out of memory long before the loop ends. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGE_CNT 256
+#define CHILD_CNT 32
+
+static char buf[PAGE_CNT * PAGE_SIZE];
+
+/* Checks every page, then writes to the one selected by ID. */
+static int
+touch (int id)
+{
+  int i;
+
+  for (i = 0; i < PAGE_CNT; i++)
+    if (buf[i * PAGE_SIZE] != (char) i
+        || buf[i * PAGE_SIZE + PAGE_SIZE - 1] != (char) i)
+      return 1;
+  buf[(id % PAGE_CNT) * PAGE_SIZE + 1] = 'x';
+  return 0;
+}
+
+void
+test_main (void)
+{
+  int i, c;
+
+  for (i = 0; i < PAGE_CNT; i++)
+    memset (buf + i * PAGE_SIZE, i, PAGE_SIZE);
+
+  msg ("fork %d children over %d shared pages", CHILD_CNT, PAGE_CNT);
+  for (c = 0; c < CHILD_CNT; c++)
+    {
+      pid_t child = fork ("child");
+      if (child == 0)
+        {
+          pid_t grandchild = fork ("grandchild");
+          if (grandchild == 0)
+            exit (touch (2 * c + 1));
+          exit (touch (2 * c) || wait (grandchild) != 0);
+        }
+      if (wait (child) != 0)
+        fail ("child %d saw bad data", c);
+    }
+
+  for (i = 0; i < PAGE_CNT; i++)
+    if (buf[i * PAGE_SIZE] != (char) i || buf[i * PAGE_SIZE + 1] != (char) i)
+      fail ("parent page %d changed", i);
+  msg ("parent data intact");
+}
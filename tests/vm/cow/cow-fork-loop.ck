@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(cow-fork-loop) begin
+(cow-fork-loop) fork 32 children over 256 shared pages
+(cow-fork-loop) parent data intact
+(cow-fork-loop) end
+EOF
+pass;
@@ -0,0 +1,88 @@
+/* Forks several children in turn from a parent whose data pages are
+   all resident.  Each child must start out sharing every page with
+   the parent, and its writes must give it private copies without
+   disturbing the parent.  Once the children are gone, the parent
+   writes to its pages without any copying. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define PAGE_CNT 32
+#define CHILD_CNT 4
+
+static char buf[PAGE_CNT * PAGE_SIZE];
+static void *pa[PAGE_CNT];
+
+static char
+fill (int page)
+{
+  return 'a' + page % 26;
+}
+
+static void
+check_page (const char *page, char c, const char *who, int i)
+{
+  if (page[0] != c || page[PAGE_SIZE / 2] != c || page[PAGE_SIZE - 1] != c)
+    fail ("%s: page %d has bad data", who, i);
+}
+
+static void
+run_child (int c)
+{
+  int i;
+
+  for (i = 0; i < PAGE_CNT; i++)
+    {
+      char *page = buf + i * PAGE_SIZE;
+
+      if (get_phys_addr (page) != pa[i])
+        fail ("child %d: page %d is not shared", c, i);
+      check_page (page, fill (i), "child", i);
+
+      memset (page, 'A' + c, PAGE_SIZE);
+      if (get_phys_addr (page) == pa[i])
+        fail ("child %d: write to page %d was not copied", c, i);
+      check_page (page, 'A' + c, "child", i);
+    }
+  msg ("child %d: shared then copied %d pages", c, PAGE_CNT);
+  exit (c);
+}
+
+void
+test_main (void)
+{
+  int i, c;
+
+  for (i = 0; i < PAGE_CNT; i++)
+    {
+      memset (buf + i * PAGE_SIZE, fill (i), PAGE_SIZE);
+      pa[i] = get_phys_addr (buf + i * PAGE_SIZE);
+    }
+
+  for (c = 0; c < CHILD_CNT; c++)
+    {
+      pid_t child = fork ("child");
+      if (child == 0)
+        run_child (c);
+      CHECK (wait (child) == c, "wait for child %d", c);
+    }
+
+  for (i = 0; i < PAGE_CNT; i++)
+    {
+      check_page (buf + i * PAGE_SIZE, fill (i), "parent", i);
+      if (get_phys_addr (buf + i * PAGE_SIZE) != pa[i])
+        fail ("parent: page %d moved", i);
+    }
+  msg ("parent data intact");
+
+  for (i = 0; i < PAGE_CNT; i++)
+    {
+      memset (buf + i * PAGE_SIZE, 'z', PAGE_SIZE);
+      if (get_phys_addr (buf + i * PAGE_SIZE) != pa[i])
+        fail ("parent: write to page %d was copied", i);
+    }
+  msg ("parent kept its frames after writing");
+}
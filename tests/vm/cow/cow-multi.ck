@@ -0,0 +1,19 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(cow-multi) begin
+(cow-multi) child 0: shared then copied 32 pages
+(cow-multi) wait for child 0
+(cow-multi) child 1: shared then copied 32 pages
+(cow-multi) wait for child 1
+(cow-multi) child 2: shared then copied 32 pages
+(cow-multi) wait for child 2
+(cow-multi) child 3: shared then copied 32 pages
+(cow-multi) wait for child 3
+(cow-multi) parent data intact
+(cow-multi) parent kept its frames after writing
+(cow-multi) end
+EOF
+pass;
@@ -0,0 +1,64 @@
+/* Checks fault-around.  The process's first fault loads and maps
+   the whole aligned window of read-only executable pages around
+   it, so read-only data in the same window as test_main() is
+   mapped before it is ever touched.  A fault on a file mapping
+   loads its neighbours too but maps only the faulting page, so
+   the other pages of the mapping still read as not loaded until
+   they are touched, and then hold the right data. */
+
+#include <string.h>
+#include <syscall.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/vm/small.inc"
+
+#define PAGE_SIZE 4096
+#define PAGE_SHIFT 12
+#define PAGE_ALIGN_CEIL(x) ((x % PAGE_SIZE ? (x+PAGE_SIZE) : x) >> PAGE_SHIFT << PAGE_SHIFT)
+
+/* Pages loaded together on a fault, as in vm/vm.c. */
+#define WINDOW (8 * PAGE_SIZE)
+
+/* Read-only data that nothing reads until the check below. */
+static const char rodata[2 * PAGE_SIZE] = { 'f', 'a' };
+
+void
+test_main (void)
+{
+	uintptr_t window = (uintptr_t) test_main / WINDOW;
+	size_t handle;
+	char *actual = (char *) 0x10000000;
+	void *map;
+	size_t i, j;
+	size_t page_cnt;
+	bool text_mapped = true;
+
+	for (i = 0; i < sizeof rodata; i += PAGE_SIZE)
+		if ((uintptr_t) &rodata[i] / WINDOW == window
+				&& get_phys_addr ((void *) &rodata[i]) == 0)
+			text_mapped = false;
+	CHECK (text_mapped, "check if text window is mapped");
+	if (rodata[0] != 'f' || rodata[1] != 'a')
+		fail ("read-only data reported bad data");
+
+	CHECK ((handle = open ("small.txt")) > 1, "open \"small.txt\"");
+	CHECK ((map = mmap (actual, PAGE_ALIGN_CEIL(sizeof small), 0, handle, 0))
+			!= MAP_FAILED, "mmap \"small.txt\"");
+	page_cnt = PAGE_ALIGN_CEIL(sizeof small) / PAGE_SIZE;
+
+	for (i = 0; i < page_cnt; i++) {
+		msg ("load page [%zu]", i);
+		if (memcmp (actual + i * PAGE_SIZE, small + i * PAGE_SIZE, 10))
+			fail ("read of mmap'd file reported bad data");
+		for (j = i + 1; j < page_cnt; j++)
+			CHECK (get_phys_addr (&actual[j * PAGE_SIZE]) == 0,
+					"check if page is not mapped");
+	}
+	if (memcmp (actual, small, sizeof small))
+		fail ("read of mmap'd file reported bad data");
+
+	munmap (map);
+	close (handle);
+}
@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(fault-around) begin
+(fault-around) check if text window is mapped
+(fault-around) open "small.txt"
+(fault-around) mmap "small.txt"
+(fault-around) load page [0]
+(fault-around) check if page is not mapped
+(fault-around) check if page is not mapped
+(fault-around) load page [1]
+(fault-around) check if page is not mapped
+(fault-around) load page [2]
+(fault-around) end
+EOF
+pass;
@@ -0,0 +1,49 @@
+/* Checks that reading untouched anonymous pages maps them all to
+   one shared page of zeros, and that the first write to a page
+   gives it a private frame without disturbing the others. */
+
+#include <string.h>
+#include <syscall.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define CHUNK_PAGE_COUNT 64
+#define CHUNK_SIZE (CHUNK_PAGE_COUNT * PAGE_SIZE)
+
+static char buf[CHUNK_SIZE] __attribute__ ((aligned (PAGE_SIZE)));
+
+void
+test_main (void)
+{
+	size_t i;
+	void *zero_pa;
+	void *pa;
+	bool all_zero = true;
+	bool all_shared = true;
+
+	msg ("read pages");
+	for (i = 0 ; i < CHUNK_PAGE_COUNT ; i++)
+		if (buf[i*PAGE_SIZE] != 0 || buf[i*PAGE_SIZE + PAGE_SIZE - 1] != 0)
+			all_zero = false;
+	CHECK (all_zero, "check if pages read as zero");
+
+	zero_pa = get_phys_addr(&buf[0]);
+	for (i = 1 ; i < CHUNK_PAGE_COUNT ; i++)
+		if (get_phys_addr(&buf[i*PAGE_SIZE]) != zero_pa)
+			all_shared = false;
+	CHECK (zero_pa != 0 && all_shared, "check if pages share one frame");
+
+	msg ("write page [1]");
+	buf[PAGE_SIZE] = 1;
+	pa = get_phys_addr(&buf[PAGE_SIZE]);
+	CHECK (pa != 0 && pa != zero_pa, "check if page got its own frame");
+	CHECK (buf[PAGE_SIZE] == 1, "check memory content");
+	CHECK (buf[0] == 0 && buf[2*PAGE_SIZE] == 0,
+			"check if other pages still read as zero");
+	CHECK (get_phys_addr(&buf[0]) == zero_pa
+			&& get_phys_addr(&buf[2*PAGE_SIZE]) == zero_pa,
+			"check if other pages still share one frame");
+}
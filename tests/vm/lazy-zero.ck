@@ -0,0 +1,17 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(lazy-zero) begin
+(lazy-zero) read pages
+(lazy-zero) check if pages read as zero
+(lazy-zero) check if pages share one frame
+(lazy-zero) write page [1]
+(lazy-zero) check if page got its own frame
+(lazy-zero) check memory content
+(lazy-zero) check if other pages still read as zero
+(lazy-zero) check if other pages still share one frame
+(lazy-zero) end
+EOF
+pass;
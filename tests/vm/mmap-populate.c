@@ -0,0 +1,49 @@
+/* Maps a file with MAP_POPULATE and checks that every page is
+   loaded with the right data before it is ever touched, and that
+   unknown flags are rejected. */
+
+#include <string.h>
+#include <syscall.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+#include "tests/vm/small.inc"
+
+#define PAGE_SIZE 4096
+#define PAGE_SHIFT 12
+#define PAGE_ALIGN_CEIL(x) ((x % PAGE_SIZE ? (x+PAGE_SIZE) : x) >> PAGE_SHIFT << PAGE_SHIFT)
+
+void
+test_main (void)
+{
+	size_t handle;
+	char *actual = (char *) 0x10000000;
+	void *map;
+	size_t i;
+	size_t page_cnt;
+	bool all_loaded = true;
+
+	CHECK ((handle = open ("small.txt")) > 1, "open \"small.txt\"");
+	CHECK (mmap_flags (actual, sizeof small, 0, handle, 0, 0x80)
+			== MAP_FAILED, "mmap with unknown flag fails");
+	CHECK ((map = mmap_flags (actual, sizeof small, 0, handle, 0,
+					MAP_POPULATE)) != MAP_FAILED,
+			"mmap \"small.txt\" with MAP_POPULATE");
+	page_cnt = PAGE_ALIGN_CEIL(sizeof small) / PAGE_SIZE;
+
+	for (i = 0 ; i < page_cnt ; i++)
+		if (get_phys_addr(&actual[i*PAGE_SIZE]) == 0)
+			all_loaded = false;
+	CHECK (all_loaded, "check if all pages are loaded");
+
+	if (memcmp (actual, small, sizeof small))
+		fail ("read of mmap'd file reported bad data");
+	for (i = sizeof small; i < page_cnt * PAGE_SIZE; i++)
+		if (actual[i] != 0)
+			fail ("byte %zu of mmap'd region has value %02hhx (should be 0)",
+					i, actual[i]);
+
+	munmap (map);
+	close (handle);
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(mmap-populate) begin
+(mmap-populate) open "small.txt"
+(mmap-populate) mmap with unknown flag fails
+(mmap-populate) mmap "small.txt" with MAP_POPULATE
+(mmap-populate) check if all pages are loaded
+(mmap-populate) end
+EOF
+pass;
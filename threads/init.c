@@ -34,7 +34,9 @@
 #endif
 #ifdef FILESYS
 #include "devices/disk.h"
+#include "filesys/fat.h"
 #include "filesys/filesys.h"
+#include "filesys/free-map.h"
 #include "filesys/fsutil.h"
 #endif
 
@@ -216,11 +218,29 @@ parse_options (char **argv) {
 #ifdef FILESYS
 		else if (!strcmp (name, "-f"))
 			format_filesys = true;
+		else if (!strcmp (name, "-fit")) {
+			if (value == NULL || !free_map_set_fit (value))
+				PANIC ("unknown placement policy `%s' (use -h for help)",
+						value != NULL ? value : "");
+		}
+#endif
+#ifdef EFILESYS
+		else if (!strcmp (name, "-cluster")) {
+			if (value == NULL || !fat_set_cluster_size (atoi (value)))
+				PANIC ("cluster size must be 1 to %d sectors",
+						MAX_SECTORS_PER_CLUSTER);
+		}
 #endif
 		else if (!strcmp (name, "-rs"))
 			random_init (atoi (value));
 		else if (!strcmp (name, "-mlfqs"))
 			thread_mlfqs = true;
+#ifdef VM
+		else if (!strcmp (name, "-kswapd")) {
+			if (value == NULL || !vm_set_watermarks (value))
+				PANIC ("watermarks must be LOW,HIGH with LOW <= HIGH");
+		}
+#endif
 #ifdef USERPROG
 		else if (!strcmp (name, "-ul"))
 			user_page_limit = atoi (value);
@@ -272,6 +292,9 @@ run_actions (char **argv) {
 		{"rm", 2, fsutil_rm},
 		{"put", 2, fsutil_put},
 		{"get", 2, fsutil_get},
+		{"defrag", 1, fsutil_defrag},
+		{"fsinfo", 1, fsutil_fsinfo},
+		{"compress", 2, fsutil_compress},
 #endif
 		{NULL, 0, NULL},
 	};
@@ -316,6 +339,9 @@ usage (void) {
 			"  ls                 List files in the root directory.\n"
 			"  cat FILE           Print FILE to the console.\n"
 			"  rm FILE            Delete FILE.\n"
+			"  defrag             Compact files and report fragmentation.\n"
+			"  fsinfo             Print the file system's cluster size.\n"
+			"  compress FILE      Store FILE compressed from now on.\n"
 			"Use these actions indirectly via `pintos' -g and -p options:\n"
 			"  put FILE           Put FILE into file system from scratch disk.\n"
 			"  get FILE           Get FILE from file system into scratch disk.\n"
@@ -324,10 +350,20 @@ usage (void) {
 			"  -h                 Print this help message and power off.\n"
 			"  -q                 Power off VM after actions or on panic.\n"
 			"  -f                 Format file system disk during startup.\n"
+#ifdef FILESYS
+			"  -fit=POLICY        Place new blocks by near, next, or best fit.\n"
+#endif
+#ifdef EFILESYS
+			"  -cluster=N         Format with N sectors per cluster (1-64).\n"
+#endif
 			"  -rs=SEED           Set random number seed to SEED.\n"
 			"  -mlfqs             Use multi-level feedback queue scheduler.\n"
 #ifdef USERPROG
 			"  -ul=COUNT          Limit user memory to COUNT pages.\n"
+#endif
+#ifdef VM
+			"  -kswapd=LOW,HIGH   Page out in the background when fewer than LOW\n"
+			"                     user frames are free, until HIGH are free.\n"
 #endif
 			);
 	power_off ();
@@ -356,10 +392,14 @@ print_stats (void) {
 	thread_print_stats ();
 #ifdef FILESYS
 	disk_print_stats ();
+	filesys_print_stats ();
 #endif
 	console_print_stats ();
 	kbd_print_stats ();
 #ifdef USERPROG
 	exception_print_stats ();
 #endif
+#ifdef VM
+	vm_print_stats ();
+#endif
 }
@@ -15,6 +15,9 @@
 #ifdef USERPROG
 #include "userprog/process.h"
 #endif
+#ifdef VM
+#include "vm/vm.h"
+#endif
 #include "filesys/file.h"
 #include "devices/timer.h"
 
@@ -315,6 +318,7 @@ thread_exit (void) {
 #ifdef USERPROG
 	process_exit ();
 #endif
+	free (thread_current ()->fs_bounce);
 
 	/* 우리의 상태를 죽는 상태로 설정하고 다른 프로세스를 스케줄링합니다.
 	   우리는 schedule_tail()을 호출하는 동안 파괴될 것입니다. */
@@ -416,6 +420,10 @@ idle (void *idle_started_ UNUSED) {
 	sema_up (idle_started);
 
 	for (;;) {
+#ifdef VM
+		/* 할 일이 없는 동안 사용자 페이지를 미리 0으로 지워 둡니다. */
+		vm_idle ();
+#endif
 		/* Let someone else run. */
 		intr_disable ();
 		thread_block ();
@@ -0,0 +1,121 @@
+#include "userprog/io_ring.h"
+#include <debug.h>
+#include "threads/thread.h"
+#include "userprog/syscall.h"
+#include "vm/vm.h"
+
+/* Batched file I/O through rings shared with user space.
+ *
+ * A process registers one struct io_ring in its own memory with
+ * io_ring_setup() and then hands the kernel any number of queued
+ * operations with a single io_ring_enter() call, which carries them
+ * out and posts their completions before returning.
+ *
+ * The work is done in the calling thread rather than by a kernel
+ * worker: the disk driver transfers data by programmed I/O in the
+ * requesting thread, and an operation's buffers are only mapped in
+ * the process's own page table, so a separate worker would gain
+ * no overlap.  What the ring saves is the trap per operation. */
+
+static void execute (const struct io_sqe *, struct io_cqe *);
+static void check_ring_page (const void *);
+
+/* Registers RING as the calling process's ring pair, replacing any
+ * earlier one, and resets its indexes.  Returns 0 if successful, -1
+ * if RING is null.  The kernel writes indexes and completions into
+ * the ring, so it must lie in writable memory. */
+int
+io_ring_setup (struct io_ring *ring) {
+	if (ring == NULL)
+		return -1;
+	check_ring_page (ring);
+	check_ring_page ((uint8_t *) ring + sizeof *ring - 1);
+
+	ring->sq_head = ring->sq_tail = 0;
+	ring->cq_head = ring->cq_tail = 0;
+	thread_current ()->io_ring = ring;
+	return 0;
+}
+
+/* Carries out up to TO_SUBMIT queued operations, in order, stopping
+ * early when the submission ring is empty or the completion ring is
+ * full.  The ring is pinned for the duration so that the kernel
+ * never faults on it.  Returns the number of operations completed,
+ * or -1 if no ring is registered. */
+int
+io_ring_enter (unsigned to_submit) {
+	struct io_ring *ring = thread_current ()->io_ring;
+	unsigned done = 0;
+
+	if (ring == NULL)
+		return -1;
+#ifdef VM
+	if (!vm_pin_range (ring, sizeof *ring))
+		exit (-1);
+#endif
+
+	while (done < to_submit
+			&& ring->sq_head != ring->sq_tail
+			&& ring->cq_tail - ring->cq_head < IO_RING_ENTRIES) {
+		struct io_sqe sqe = ring->sq[ring->sq_head % IO_RING_ENTRIES];
+		struct io_cqe *cqe = &ring->cq[ring->cq_tail % IO_RING_ENTRIES];
+
+		ring->sq_head++;
+		execute (&sqe, cqe);
+		ring->cq_tail++;
+		done++;
+	}
+
+#ifdef VM
+	vm_unpin_range (ring, sizeof *ring);
+#endif
+	return done;
+}
+
+/* Exits the process unless ADDR is user memory that the kernel may
+ * write into. */
+static void
+check_ring_page (const void *addr) {
+	check_address ((void *) addr);
+#ifdef VM
+	struct page *page = spt_find_page (&thread_current ()->spt,
+			(void *) addr);
+	if (page == NULL || !page->writable)
+		exit (-1);
+#endif
+}
+
+/* Carries out SQE and fills in CQE.  Bad buffers or file names
+ * terminate the process, as they would for the equivalent system
+ * call. */
+static void
+execute (const struct io_sqe *sqe, struct io_cqe *cqe) {
+	void *addr = (void *) sqe->addr;
+	int res;
+
+	switch (sqe->opcode) {
+		case IO_RING_NOP:
+			res = 0;
+			break;
+		case IO_RING_READ:
+			res = sqe->offset < 0 ? read (sqe->fd, addr, sqe->len)
+				: pread (sqe->fd, addr, sqe->len, sqe->offset);
+			break;
+		case IO_RING_WRITE:
+			res = sqe->offset < 0 ? write (sqe->fd, addr, sqe->len)
+				: pwrite (sqe->fd, addr, sqe->len, sqe->offset);
+			break;
+		case IO_RING_OPEN:
+			res = open (addr);
+			break;
+		case IO_RING_CLOSE:
+			close (sqe->fd);
+			res = 0;
+			break;
+		default:
+			res = -1;
+			break;
+	}
+	cqe->user_data = sqe->user_data;
+	cqe->res = res;
+}
@@ -228,6 +228,10 @@ __do_fork (void *aux) {
 
 	process_activate (current);
 #ifdef VM
+	/* 자식의 코드 페이지가 참조하도록 실행 파일을 따로 연다. */
+	if (parent->running_file != NULL
+			&& (current->running_file = file_reopen (parent->running_file)) == NULL)
+		goto error;
 	supplemental_page_table_init (&current->spt);
 	if (!supplemental_page_table_copy (&current->spt, &parent->spt))
 		goto error;
@@ -287,6 +291,7 @@ process_exec (void *f_name) {
 
 	/* We first kill the current context */
 	process_cleanup ();
+	thread_current ()->io_ring = NULL;
 	// printf("cleanup_failed\n");
 	/* And then load the binary */
 	// success = load (file_name, &_if);
@@ -397,11 +402,12 @@ process_exit (void) {
 	}
 	palloc_free_page(table);
 
+	/* 코드 페이지가 실행 파일을 참조하므로 페이지를 먼저 정리한다. */
+	process_cleanup ();
+
 	if (curr->running_file)
 		file_close (curr->running_file);
 
-	process_cleanup ();
-
 	sema_up(&curr->sema_wait);
 
 	sema_down(&curr->sema_exit);
@@ -886,6 +892,16 @@ static bool load_segment (struct file *file, off_t ofs, uint8_t *upage,
 		// 			writable, lazy_load_segment, aux))
 		// 	return false;
 
+		/* 파일에서 읽을 내용이 없는 BSS 페이지는 스택처럼 초기화 함수 없이
+		   등록해 읽기 폴트에서 공유 제로 페이지를 매핑할 수 있게 한다. */
+		if (page_read_bytes == 0) {
+			if (!vm_alloc_page (VM_ANON, upage, writable))
+				return false;
+			zero_bytes -= page_zero_bytes;
+			upage += PGSIZE;
+			continue;
+		}
+
 		struct file_page *load_info = (struct file_page *)malloc(sizeof(struct file_page));
 		if(load_info == NULL){
 			// printf("load_info failed\n");
@@ -897,8 +913,17 @@ static bool load_segment (struct file *file, off_t ofs, uint8_t *upage,
 		load_info->ofs = ofs;
 		load_info->read_bytes = page_read_bytes;
 		load_info->zero_bytes = page_zero_bytes;
-
-		if (!vm_alloc_page_with_initializer (VM_ANON, upage, writable, lazy_load_segment, load_info)){
+		load_info->text = !writable;
+
+		/* 읽기 전용 코드 페이지는 파일 페이지로 만들어, 같은 실행 파일을
+		   실행하는 프로세스들이 프레임을 공유하고 축출 시 스왑 없이
+		   버렸다가 파일에서 다시 읽게 한다. */
+		if (!writable) {
+			if (!vm_alloc_page_with_initializer (VM_FILE, upage, false,
+						load_file, load_info))
+				return false;
+		}
+		else if (!vm_alloc_page_with_initializer (VM_ANON, upage, writable, lazy_load_segment, load_info)){
 			// printf("vm_alloc_page_with_initializer failed\n");
 			// free(load_info);	
 			return false;
@@ -1,6 +1,10 @@
 #include "userprog/syscall.h"
+#include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include <syscall-nr.h>
+#include <mman.h>
+#include <uio.h>
 #include "threads/interrupt.h"
 #include "threads/thread.h"
 #include "threads/loader.h"
@@ -11,6 +15,8 @@
 #include "filesys/file.h"
 #include "filesys/filesys.h"
 #include "threads/palloc.h"
+#include "devices/disk.h"
+#include "userprog/io_ring.h"
 #include "userprog/process.h"
 #include "vm/vm.h"
 
@@ -18,6 +24,22 @@
 
 void syscall_entry (void);
 void syscall_handler (struct intr_frame *);
+static bool pin_user_buffer (const void *buffer, unsigned size);
+static void unpin_user_buffer (const void *buffer, unsigned size);
+static struct file *get_file (int fd);
+static void check_buffer (const void *buffer, unsigned size, bool store);
+static void check_string (const char *str);
+static int transfer_vector (int fd, const struct iovec *iov, int iovcnt,
+		bool write);
+
+/* Transfers of at least this many bytes pin the user buffer so that
+ * inode_read_at()/inode_write_at() move whole sectors directly between
+ * the disk and user memory, without faulting while the disk channel
+ * is held. */
+#define PIN_THRESHOLD DISK_SECTOR_SIZE
+
+/* Size of a thread's file descriptor table. */
+#define FDT_COUNT_LIMIT 128
 
 /* System call.
  *
@@ -105,11 +127,52 @@ syscall_handler (struct intr_frame *f UNUSED) {
 		case SYS_CLOSE:
 			close (f->R.rdi);
 			break;
+		case SYS_DEFRAG:
+			f->R.rax = defrag ((const char *) f->R.rdi);
+			break;
+		case SYS_STATFS:
+			f->R.rax = statfs ((struct statfs *) f->R.rdi);
+			break;
+		case SYS_PREAD:
+			f->R.rax = pread (f->R.rdi, (void *) f->R.rsi, f->R.rdx, f->R.r10);
+			break;
+		case SYS_PWRITE:
+			f->R.rax = pwrite (f->R.rdi, (const void *) f->R.rsi, f->R.rdx,
+					f->R.r10);
+			break;
+		case SYS_READV:
+			f->R.rax = readv (f->R.rdi, (const struct iovec *) f->R.rsi, f->R.rdx);
+			break;
+		case SYS_WRITEV:
+			f->R.rax = writev (f->R.rdi, (const struct iovec *) f->R.rsi, f->R.rdx);
+			break;
+		case SYS_COPY_FILE_RANGE:
+			f->R.rax = copy_file_range (f->R.rdi, (off_t *) f->R.rsi, f->R.rdx,
+					(off_t *) f->R.r10, f->R.r8);
+			break;
+		case SYS_FALLOCATE:
+			f->R.rax = fallocate (f->R.rdi, f->R.rsi, f->R.rdx);
+			break;
+		case SYS_READDIR_BATCH:
+			f->R.rax = readdir_batch (f->R.rdi, (void *) f->R.rsi, f->R.rdx);
+			break;
+		case SYS_IO_RING_SETUP:
+			f->R.rax = io_ring_setup ((struct io_ring *) f->R.rdi);
+			break;
+		case SYS_IO_RING_ENTER:
+			f->R.rax = io_ring_enter (f->R.rdi);
+			break;
+		case SYS_FSYNC:
+			f->R.rax = fsync (f->R.rdi);
+			break;
+		case SYS_FDATASYNC:
+			f->R.rax = fdatasync (f->R.rdi);
+			break;
 
 		#ifdef VM
 
 		case SYS_MMAP:
-        	f->R.rax = mmap(f->R.rdi, f->R.rsi, f->R.rdx, f->R.r10, f->R.r8);
+        	f->R.rax = mmap(f->R.rdi, f->R.rsi, f->R.rdx, f->R.r10, f->R.r8, f->R.r9);
         	break;
     	case SYS_MUNMAP:
         	munmap(f->R.rdi);
@@ -253,10 +316,12 @@ int read (int fd, void *buffer, unsigned size) {
     #endif
 
 	if (file) {
+		bool pinned = pin_user_buffer (buffer, size);
 		lock_acquire (&filesys_lock);
 		int read_byte = file_read (file, buffer, size);
 		lock_release (&filesys_lock);
-		
+		if (pinned)
+			unpin_user_buffer (buffer, size);
 		
 		return read_byte;
 		
@@ -281,9 +346,12 @@ int write (int fd UNUSED, const void *buffer, unsigned size) {
 	struct file *file = thread_current ()->fdt[fd];
 
 	if (file) {
+		bool pinned = pin_user_buffer (buffer, size);
 		lock_acquire (&filesys_lock);
 		int write_byte = file_write (file, buffer, size);
 		lock_release (&filesys_lock);
+		if (pinned)
+			unpin_user_buffer (buffer, size);
 		return write_byte;
 	}
 }
@@ -324,6 +392,337 @@ void close (int fd) {
 	}
 }
 
+/* Reads SIZE bytes from FD at byte OFFSET into BUFFER, leaving the
+ * file position unchanged.  Returns the number of bytes read, or -1
+ * if FD is not an open file. */
+int pread (int fd, void *buffer, unsigned size, off_t offset) {
+	struct file *file = get_file (fd);
+	int read_byte;
+	bool pinned;
+
+	if (file == NULL || offset < 0)
+		return -1;
+	check_buffer (buffer, size, true);
+
+	pinned = pin_user_buffer (buffer, size);
+	lock_acquire (&filesys_lock);
+	read_byte = file_read_at (file, buffer, size, offset);
+	lock_release (&filesys_lock);
+	if (pinned)
+		unpin_user_buffer (buffer, size);
+
+	return read_byte;
+}
+
+/* Writes SIZE bytes from BUFFER to FD at byte OFFSET, leaving the
+ * file position unchanged.  Returns the number of bytes written, or
+ * -1 if FD is not an open file. */
+int pwrite (int fd, const void *buffer, unsigned size, off_t offset) {
+	struct file *file = get_file (fd);
+	int write_byte;
+	bool pinned;
+
+	if (file == NULL || offset < 0)
+		return -1;
+	check_buffer (buffer, size, false);
+
+	pinned = pin_user_buffer (buffer, size);
+	lock_acquire (&filesys_lock);
+	write_byte = file_write_at (file, buffer, size, offset);
+	lock_release (&filesys_lock);
+	if (pinned)
+		unpin_user_buffer (buffer, size);
+
+	return write_byte;
+}
+
+/* Reads from FD into the IOVCNT buffers described by IOV, in order,
+ * advancing the file position.  Returns the total number of bytes
+ * read, or -1 on bad arguments. */
+int readv (int fd, const struct iovec *iov, int iovcnt) {
+	return transfer_vector (fd, iov, iovcnt, false);
+}
+
+/* Writes the IOVCNT buffers described by IOV to FD, in order,
+ * advancing the file position.  Returns the total number of bytes
+ * written, or -1 on bad arguments. */
+int writev (int fd, const struct iovec *iov, int iovcnt) {
+	return transfer_vector (fd, iov, iovcnt, true);
+}
+
+/* Copies SIZE bytes from FD_IN to FD_OUT without passing them
+ * through user memory.  If OFF_IN is non-null, reading starts at
+ * *OFF_IN, which is advanced past the bytes copied, and FD_IN's
+ * file position is left alone; otherwise the file position is used
+ * and advanced.  OFF_OUT works the same way for FD_OUT.
+ * Returns the number of bytes copied, or -1 on bad arguments. */
+int copy_file_range (int fd_in, off_t *off_in, int fd_out, off_t *off_out,
+		unsigned size) {
+	struct file *in = get_file (fd_in);
+	struct file *out = get_file (fd_out);
+	off_t in_ofs = 0, out_ofs = 0;
+	int copied = -1;
+
+	if (in == NULL || out == NULL)
+		return -1;
+	if (off_in != NULL) {
+		check_buffer (off_in, sizeof *off_in, true);
+		in_ofs = *off_in;
+	}
+	if (off_out != NULL) {
+		check_buffer (off_out, sizeof *off_out, true);
+		out_ofs = *off_out;
+	}
+
+	lock_acquire (&filesys_lock);
+	if (off_in == NULL)
+		in_ofs = file_tell (in);
+	if (off_out == NULL)
+		out_ofs = file_tell (out);
+	if (in_ofs >= 0 && out_ofs >= 0)
+		copied = file_copy_range (in, in_ofs, out, out_ofs, size);
+	if (copied > 0 && off_in == NULL)
+		file_seek (in, in_ofs + copied);
+	if (copied > 0 && off_out == NULL)
+		file_seek (out, out_ofs + copied);
+	lock_release (&filesys_lock);
+
+	if (copied > 0 && off_in != NULL)
+		*off_in = in_ofs + copied;
+	if (copied > 0 && off_out != NULL)
+		*off_out = out_ofs + copied;
+	return copied;
+}
+
+/* Reserves contiguous disk space so that FD can grow to OFFSET + LEN
+ * bytes, without changing its size.  Appends then land in the
+ * reserved space.  Returns false if FD is not an open file or no
+ * contiguous free range is large enough. */
+bool fallocate (int fd, off_t offset, off_t len) {
+	struct file *file = get_file (fd);
+	bool success;
+
+	if (file == NULL || offset < 0 || len <= 0 || len > INT32_MAX - offset)
+		return false;
+
+	lock_acquire (&filesys_lock);
+	success = file_allocate (file, offset, len);
+	lock_release (&filesys_lock);
+
+	return success;
+}
+
+/* Writes FD's data, and then the metadata that locates it, to disk
+ * and waits for the writes to finish.  Only FD's file is flushed.
+ * Returns 0 if successful, -1 if FD is not an open file or its
+ * data could not be written. */
+int fsync (int fd) {
+	struct file *file = get_file (fd);
+	bool success;
+
+	if (file == NULL)
+		return -1;
+
+	lock_acquire (&filesys_lock);
+	success = file_sync (file, true);
+	lock_release (&filesys_lock);
+
+	return success ? 0 : -1;
+}
+
+/* Like fsync(), but writes only FD's data.  Inodes are written
+ * through whenever their length changes, so the data is reachable
+ * once this returns. */
+int fdatasync (int fd) {
+	struct file *file = get_file (fd);
+	bool success;
+
+	if (file == NULL)
+		return -1;
+
+	lock_acquire (&filesys_lock);
+	success = file_sync (file, false);
+	lock_release (&filesys_lock);
+
+	return success ? 0 : -1;
+}
+
+/* Fills BUFFER, SIZE bytes long, with packed `struct dirent' records
+ * for the directory open as FD (see <dirent.h>), resuming where the
+ * previous call stopped.  The records are built in a kernel page
+ * and copied out once, so at most a page is returned per call.
+ * Returns the number of bytes filled, 0 at end of directory, or -1
+ * if FD is not an open directory or BUFFER is too small for one
+ * record. */
+int readdir_batch (int fd, void *buffer, size_t size) {
+	struct file *file = get_file (fd);
+	void *kbuf;
+	int bytes;
+
+	if (file == NULL || size == 0)
+		return -1;
+	if (size > PGSIZE)
+		size = PGSIZE;
+	check_buffer (buffer, size, true);
+
+	kbuf = palloc_get_page (0);
+	if (kbuf == NULL)
+		return -1;
+	lock_acquire (&filesys_lock);
+	bytes = filesys_readdir_batch (file, kbuf, size);
+	lock_release (&filesys_lock);
+	if (bytes > 0)
+		memcpy (buffer, kbuf, bytes);
+	palloc_free_page (kbuf);
+
+	return bytes;
+}
+
+/* Moves FILE's data toward the start of the disk, or only measures
+ * if FILE is a null pointer.  Returns the resulting fragmentation
+ * score, or -1 if FILE does not exist. */
+int defrag (const char *file) {
+	int score = -1;
+
+	if (file != NULL)
+		check_string (file);
+
+	lock_acquire (&filesys_lock);
+	if (file == NULL || filesys_defrag (file))
+		score = filesys_fragmentation ();
+	lock_release (&filesys_lock);
+
+	return score;
+}
+
+/* Stores the file system's size and usage into BUF.  Returns 0. */
+int statfs (struct statfs *buf) {
+	struct statfs st;
+
+	check_buffer (buf, sizeof *buf, true);
+
+	lock_acquire (&filesys_lock);
+	filesys_statfs (&st);
+	lock_release (&filesys_lock);
+	memcpy (buf, &st, sizeof st);
+
+	return 0;
+}
+
+/* Does the work of readv() and writev().  The vector is copied in
+ * and every buffer validated and pinned before taking
+ * filesys_lock, so that the whole transfer is one lock acquisition
+ * and no page fault is taken while holding it.  Stops at the first
+ * short transfer. */
+static int
+transfer_vector (int fd, const struct iovec *iov, int iovcnt, bool write) {
+	struct iovec kiov[IOV_MAX];
+	bool pinned[IOV_MAX];
+	struct file *file = NULL;
+	int total = 0;
+	int i;
+
+	if (iovcnt < 0 || iovcnt > IOV_MAX)
+		return -1;
+	if (!(write && fd == 1)) {
+		file = get_file (fd);
+		if (file == NULL)
+			return -1;
+	}
+	if (iovcnt == 0)
+		return 0;
+	check_buffer (iov, iovcnt * sizeof *iov, false);
+	memcpy (kiov, iov, iovcnt * sizeof *iov);
+
+	for (i = 0; i < iovcnt; i++)
+		check_buffer (kiov[i].iov_base, kiov[i].iov_len, !write);
+	for (i = 0; i < iovcnt; i++)
+		pinned[i] = pin_user_buffer (kiov[i].iov_base, kiov[i].iov_len);
+
+	lock_acquire (&filesys_lock);
+	for (i = 0; i < iovcnt; i++) {
+		off_t n;
+
+		if (file == NULL) {
+			putbuf (kiov[i].iov_base, kiov[i].iov_len);
+			n = kiov[i].iov_len;
+		} else if (write)
+			n = file_write (file, kiov[i].iov_base, kiov[i].iov_len);
+		else
+			n = file_read (file, kiov[i].iov_base, kiov[i].iov_len);
+		total += n;
+		if ((size_t) n < kiov[i].iov_len)
+			break;
+	}
+	lock_release (&filesys_lock);
+
+	for (i = 0; i < iovcnt; i++)
+		if (pinned[i])
+			unpin_user_buffer (kiov[i].iov_base, kiov[i].iov_len);
+
+	return total;
+}
+
+/* Returns the open file for FD, or a null pointer if FD is not a
+ * file descriptor of an open file. */
+static struct file *
+get_file (int fd) {
+	if (fd < 2 || fd >= FDT_COUNT_LIMIT)
+		return NULL;
+	return thread_current ()->fdt[fd];
+}
+
+/* Exits the process unless SIZE bytes at BUFFER are user memory,
+ * and, if STORE, memory the kernel may write into. */
+static void
+check_buffer (const void *buffer, unsigned size, bool store UNUSED) {
+	check_address ((void *) buffer);
+	if (size > 0)
+		check_address ((void *) ((const uint8_t *) buffer + size - 1));
+#ifdef VM
+	if (store) {
+		struct page *page = spt_find_page (&thread_current ()->spt,
+				(void *) buffer);
+		if (page != NULL && !page->writable)
+			exit (-1);
+	}
+#endif
+}
+
+/* Exits the process unless every byte of STR, up to and including
+ * its null terminator, lies in user memory.  Unmapped pages fault
+ * and exit through page_fault(). */
+static void
+check_string (const char *str) {
+	check_address ((void *) str);
+	for (; *str != '\0'; str++)
+		if (pg_ofs (str + 1) == 0)
+			check_address ((void *) (str + 1));
+}
+
+/* Pins BUFFER for a large file transfer.  Returns true if the caller
+ * must unpin it afterwards. */
+static bool
+pin_user_buffer (const void *buffer UNUSED, unsigned size UNUSED) {
+#ifdef VM
+	if (size < PIN_THRESHOLD)
+		return false;
+	if (!vm_pin_range (buffer, size))
+		exit (-1);
+	return true;
+#else
+	return false;
+#endif
+}
+
+/* Releases a pin taken by pin_user_buffer(). */
+static void
+unpin_user_buffer (const void *buffer UNUSED, unsigned size UNUSED) {
+#ifdef VM
+	vm_unpin_range (buffer, size);
+#endif
+}
+
 void check_address (void *addr) {
 	if (addr == NULL || !is_user_vaddr((uint64_t)addr))
     {
@@ -333,8 +732,6 @@ void check_address (void *addr) {
 
 #ifdef VM
 
-#define FDT_COUNT_LIMIT 128
-
 // 파일 객체를 검색하는 함수
 struct file *process_get_file(int fd)
 {
@@ -347,10 +744,16 @@ struct file *process_get_file(int fd)
 	return fdt[fd];
 }
 
-void *mmap(void *addr, size_t length, int writable, int fd, off_t offset)
+void *mmap(void *addr, size_t length, int writable, int fd, off_t offset,
+		int flags)
 {
+	void *start;
+
 	if (!addr || addr != pg_round_down(addr))
 		return NULL;
+
+	if (flags & ~(MAP_POPULATE | MAP_LOCKED))
+		return NULL;
 	
 	if (offset != pg_round_down(offset))
 		return NULL;
@@ -368,7 +771,15 @@ void *mmap(void *addr, size_t length, int writable, int fd, off_t offset)
 	if (file_length(f) == 0 || (int)length <= 0)
 		return NULL;
 
-	return do_mmap(addr, length, writable, f, offset); // 파일이 매핑된 가상 주소 반환
+	start = do_mmap(addr, length, writable, f, offset); // 파일이 매핑된 가상 주소 반환
+
+	/* 요청이 있으면 매핑 전체를 미리 읽어 들이고, 필요하면 고정한다. */
+	if (start != NULL && (flags & (MAP_POPULATE | MAP_LOCKED))
+			&& !vm_populate(start, length, flags & MAP_LOCKED)) {
+		do_munmap(start);
+		return NULL;
+	}
+	return start;
 }
 
 void munmap(void *addr){
@@ -1,8 +1,11 @@
 /* anon.c: Implementation of page for non-disk image (a.k.a. anonymous page). */
 
+#include <stdio.h>
 #include "vm/vm.h"
 #include "devices/disk.h"
+#include "threads/malloc.h"
 #include "threads/mmu.h"
+#include "threads/synch.h"
 #include "lib/kernel/bitmap.h"
 
 #define SLOT 8
@@ -11,6 +14,39 @@ struct bitmap *swap_bitmap;
 size_t swap_slots;
 disk_sector_t sectors;
 
+/* Swap slot allocator.  Slots are handed out next-fit: each search
+ * starts where the previous allocation ended, so pages evicted one
+ * after another land in consecutive slots and the swap disk is
+ * written sequentially instead of being rescanned from slot 0.
+ * Evicting a copy-on-write frame shared by several processes points
+ * all of its pages at one slot, so each slot counts the pages that
+ * refer to it and is freed when the last one lets go. */
+static struct lock swap_lock;
+static size_t swap_cursor;
+static unsigned *swap_refs;            /* Pages referring to each slot. */
+
+static size_t swap_slot_alloc (size_t cnt);
+static void swap_slot_free (size_t slot);
+static void swap_write (struct page *pages[], size_t cnt);
+
+/* Swap readahead.  A swap-in also reads the slots of the pages that
+ * follow the faulting page in virtual memory, when they were swapped
+ * out to the slots right after its own, and leaves those pages
+ * staged: in a frame but unmapped, with their slot still reserved.
+ * A later fault on a staged page only has to map it, which counts as
+ * a hit.  Evicting or destroying a staged page that was never mapped
+ * counts as a miss; eviction costs no write, since the slot still
+ * holds the page.  The window grows by a page on each hit and shrinks
+ * by a page on each miss. */
+#define RA_MIN 2
+#define RA_MAX SWAP_BATCH_MAX
+static size_t ra_window = RA_MAX / 2;  /* Slots read per swap-in. */
+static long long ra_pages;             /* Pages staged by readahead. */
+static long long ra_hits;              /* Staged pages later mapped. */
+
+static void swap_read_ahead (struct page *page, void *kva);
+static void ra_miss (void);
+
 /* DO NOT MODIFY BELOW LINE */
 static struct disk *swap_disk;
 static bool anon_swap_in (struct page *page, void *kva);
@@ -38,6 +74,11 @@ vm_anon_init (void) {
     swap_disk = disk_get(1, 1);
     sectors = disk_size(swap_disk) / SLOT;
  	swap_bitmap = bitmap_create(sectors);
+	swap_refs = calloc(sectors, sizeof *swap_refs);
+	if (swap_bitmap == NULL || swap_refs == NULL)
+		PANIC("swap table creation failed");
+	lock_init(&swap_lock);
+	swap_cursor = 0;
 
 }
 
@@ -51,6 +92,7 @@ anon_initializer (struct page *page, enum vm_type type, void *kva) {
 
 	struct anon_page *anon_page = &page->anon;
  	anon_page->offset = -1;
+	anon_page->staged = false;
 
     return true;
 
@@ -75,14 +117,94 @@ static bool anon_swap_in (struct page *page, void *kva) {
         PANIC("스왑디스크에 없음. 따라서 swap in 못함!");
     }
 
-    for (int i = 0; i < SLOT; ++i)
-    {
-        disk_read(swap_disk, offset * SLOT + i, kva + (i * DISK_SECTOR_SIZE));
-    }
-    bitmap_flip(swap_bitmap, offset);
+    swap_read_ahead(page, kva);
+    swap_slot_free(offset);
+    anon_page->offset = -1;
     return true;
 }
 
+/* Reads PAGE's swap slot into KVA, along with the slots of as many
+ * of the following virtual pages as the readahead window allows,
+ * provided they are swapped out to consecutive slots and spare frames
+ * are available, all in one transfer.  The extra pages are staged. */
+static void
+swap_read_ahead (struct page *page, void *kva) {
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+	size_t slot = page->anon.offset;
+	struct page *pages[RA_MAX];
+	struct frame *frames[RA_MAX];
+	void *bufs[RA_MAX];
+	size_t cnt = 1, i;
+
+	bufs[0] = kva;
+	while (cnt < ra_window) {
+		struct page *next = spt_find_page (spt, page->va + cnt * PGSIZE);
+
+		if (next == NULL || next->operations != &anon_ops
+				|| next->frame != NULL || next->anon.offset != slot + cnt)
+			break;
+		frames[cnt] = vm_get_spare_frame ();
+		if (frames[cnt] == NULL)
+			break;
+		pages[cnt] = next;
+		bufs[cnt] = frames[cnt]->kva;
+		cnt++;
+	}
+
+	disk_read_scatter (swap_disk, slot * SLOT, bufs, cnt, SLOT);
+
+	for (i = 1; i < cnt; i++) {
+		pages[i]->anon.staged = true;
+		pml4_set_accessed (pages[i]->pml4, pages[i]->va, false);
+		vm_stage_page (frames[i], pages[i]);
+	}
+	ra_pages += cnt - 1;
+}
+
+/* Called before PAGE, which has a frame, is mapped.  If readahead
+ * staged PAGE, counts a hit and releases the swap slot still holding
+ * a copy of PAGE, since the mapped page may change. */
+void
+anon_unstage (struct page *page) {
+	struct anon_page *anon_page = &page->anon;
+
+	if (!anon_page->staged)
+		return;
+	anon_page->staged = false;
+	swap_slot_free (anon_page->offset);
+	anon_page->offset = -1;
+	ra_hits++;
+	if (ra_window < RA_MAX)
+		ra_window++;
+}
+
+/* Counts a staged page that was dropped without being mapped. */
+static void
+ra_miss (void) {
+	if (ra_window > RA_MIN)
+		ra_window--;
+}
+
+/* Prints swap readahead statistics. */
+void
+anon_print_stats (void) {
+	printf ("Swap: %lld pages read ahead, %lld hits\n", ra_pages, ra_hits);
+}
+
+/* Page initializer used by fork: fills PAGE with the contents of
+ * AUX, a swapped-out anonymous page of the parent, leaving the
+ * parent's swap slot in place. */
+bool
+anon_copy_swapped (struct page *page, void *aux) {
+	struct page *src = aux;
+	size_t offset = src->anon.offset;
+
+	ASSERT (bitmap_test (swap_bitmap, offset));
+
+	disk_read_multiple (swap_disk, offset * SLOT, page->frame->kva, SLOT);
+	return true;
+}
+
 /* Swap out the page by writing contents to the swap disk. */
 /* 페이지의 내용을 스왑 디스크에 쓰고 페이지를 스왑 아웃하세요. */
 /*
@@ -93,26 +215,118 @@ static bool anon_swap_in (struct page *page, void *kva) {
 디스크에 사용 가능한 슬롯이 더 이상 없으면 커널 패닉이 발생할 수 있습니다.
 */
 static bool anon_swap_out (struct page *page) {
-	struct anon_page *anon_page = &page->anon;
-    uint64_t *pml4 = thread_current()->pml4;
-    void *buff = page->frame->kva;
-    size_t offset;
+	anon_swap_out_batch (&page, 1);
+	return true;
+}
 
-    if ((offset = bitmap_scan_and_flip(swap_bitmap, 0, 1, 0)) == BITMAP_ERROR)
-    {
-        PANIC("bitmap error");
-    }
+/* Swaps out the CNT anonymous pages in PAGES, each held in a frame
+ * that vm_get_victim() returned.  Staged pages are simply dropped,
+ * since their slots still hold them.  The rest get a run of
+ * consecutive swap slots and are written in a single transfer, so a
+ * batch of victims costs one sequential write instead of CNT
+ * scattered ones. */
+void
+anon_swap_out_batch (struct page *pages[], size_t cnt) {
+	struct page *dirty[SWAP_BATCH_MAX];
+	size_t dirty_cnt = 0, i;
 
-    // 512 바이트 단위로 끊어서 작성? 8 번
-    for (int i = 0; i < SLOT; ++i)
-    {
-        disk_write(swap_disk, offset * SLOT + i, buff + (i * DISK_SECTOR_SIZE));
-    } 
+	ASSERT (cnt > 0 && cnt <= SWAP_BATCH_MAX);
 
-    anon_page->offset = offset;
-    page->frame = NULL;
-    pml4_clear_page(pml4, page->va);
-	return true;
+	for (i = 0; i < cnt; i++) {
+		struct page *page = pages[i];
+
+		if (page->anon.staged) {
+			page->anon.staged = false;
+			page->frame = NULL;
+			ra_miss ();
+		} else
+			dirty[dirty_cnt++] = page;
+	}
+	if (dirty_cnt > 0)
+		swap_write (dirty, dirty_cnt);
+}
+
+/* Writes the CNT pages in PAGES to a run of consecutive free swap
+ * slots, or one page at a time when no run is long enough.  Every
+ * other page sharing a page's frame is unmapped as well and refers
+ * to the same slot. */
+static void
+swap_write (struct page *pages[], size_t cnt) {
+	const void *kvas[SWAP_BATCH_MAX];
+	struct list_elem *e;
+	size_t first, i;
+
+	first = swap_slot_alloc (cnt);
+	if (first == BITMAP_ERROR) {
+		if (cnt == 1)
+			PANIC ("swap disk is full");
+		for (i = 0; i < cnt; i++)
+			swap_write (&pages[i], 1);
+		return;
+	}
+
+	/* 쓰는 동안 소유자가 고친 내용이 사라지지 않도록 매핑부터
+	   지운다.  축출은 다른 프로세스의 페이지에 대해서도 일어나므로
+	   현재 스레드가 아니라 페이지 소유자의 페이지 테이블을 쓴다.
+	   축출 중인 프레임은 고정되어 있어 공유자 목록이 바뀌지 않는다. */
+	for (i = 0; i < cnt; i++) {
+		struct frame *frame = pages[i]->frame;
+
+		for (e = list_begin (&frame->sharers); e != list_end (&frame->sharers);
+				e = list_next (e)) {
+			struct page *p = list_entry (e, struct page, share_elem);
+			pml4_clear_page (p->pml4, p->va);
+		}
+		kvas[i] = frame->kva;
+	}
+
+	disk_write_gather (swap_disk, first * SLOT, kvas, cnt, SLOT);
+
+	for (i = 0; i < cnt; i++) {
+		struct frame *frame = pages[i]->frame;
+
+		lock_acquire (&swap_lock);
+		swap_refs[first + i] = frame->ref_cnt;
+		lock_release (&swap_lock);
+		for (e = list_begin (&frame->sharers); e != list_end (&frame->sharers);
+				e = list_next (e)) {
+			struct page *p = list_entry (e, struct page, share_elem);
+			p->anon.offset = first + i;
+			p->frame = NULL;
+		}
+	}
+}
+
+/* Reserves CNT consecutive free swap slots and returns the first, or
+ * BITMAP_ERROR if there is no such run. */
+static size_t
+swap_slot_alloc (size_t cnt) {
+	size_t slot;
+
+	lock_acquire (&swap_lock);
+	slot = bitmap_scan_and_flip (swap_bitmap, swap_cursor, cnt, false);
+	if (slot == BITMAP_ERROR && swap_cursor > 0)
+		slot = bitmap_scan_and_flip (swap_bitmap, 0, cnt, false);
+	if (slot != BITMAP_ERROR) {
+		size_t i;
+
+		swap_cursor = (slot + cnt) % bitmap_size (swap_bitmap);
+		for (i = 0; i < cnt; i++)
+			swap_refs[slot + i] = 1;
+	}
+	lock_release (&swap_lock);
+	return slot;
+}
+
+/* Drops one page's reference to swap slot SLOT, releasing the slot
+ * when no page refers to it any more. */
+static void
+swap_slot_free (size_t slot) {
+	lock_acquire (&swap_lock);
+	ASSERT (swap_refs[slot] > 0);
+	if (--swap_refs[slot] == 0)
+		bitmap_reset (swap_bitmap, slot);
+	lock_release (&swap_lock);
 }
 
 
@@ -120,11 +334,24 @@ static bool anon_swap_out (struct page *page) {
 /* 익명 페이지를 파괴하세요. 페이지는 호출자에 의해 해제될 것입니다. */
 static void anon_destroy (struct page *page) {
 	struct anon_page *anon_page = &page->anon;
-	struct frame *frame = page->frame;
-	if (frame != NULL){
+	struct frame *frame;
+	int remaining = vm_frame_detach(page, &frame);
+	if (frame != NULL && anon_page->staged){
+		/* 미리 읽어 두기만 하고 매핑하지 않은 페이지는
+		   pml4_destroy()가 해제하지 않으므로 직접 해제한다. */
+		anon_page->staged = false;
+		ra_miss();
+		palloc_free_page(frame->kva);
 		vm_free_frame(frame);
+	} else if (frame != NULL){
+		/* 다른 프로세스가 아직 공유 중이면 pml4_destroy()가 프레임을
+		   해제하지 않도록 매핑만 지운다. */
+		if (remaining == 0)
+			vm_free_frame(frame);
+		else
+			pml4_clear_page(page->pml4, page->va);
     }
 
-    if (anon_page->offset != -1)
-        bitmap_set(swap_bitmap, anon_page->offset, 0);
+    if (anon_page->offset != (size_t) -1)
+        swap_slot_free(anon_page->offset);
 }
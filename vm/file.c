@@ -40,6 +40,7 @@ file_backed_initializer (struct page *page, enum vm_type type, void *kva) {
 	file_page->ofs = copy_page->ofs;
 	file_page->read_bytes = copy_page->read_bytes;
 	file_page->zero_bytes = copy_page->zero_bytes;
+	file_page->text = copy_page->text;
 
 	return true;
 
@@ -67,16 +68,21 @@ file_backed_swap_in (struct page *page, void *kva) {
 static bool
 file_backed_swap_out (struct page *page) {
 	struct file_page *file_page UNUSED = &page->file;
-	
-	if (pml4_is_dirty(thread_current()->pml4, page->va))
+	/* 축출은 다른 프로세스의 페이지에 대해서도 일어나므로 소유자의
+	   페이지 테이블로 dirty bit를 보고, 사용자 주소 대신 커널
+	   주소에서 써 낸다.  쓰는 동안 고친 내용이 사라지지 않도록
+	   매핑부터 지운다. */
+	uint64_t *pml4 = page->pml4;
+
+	pml4_clear_page(pml4, page->va);
+	if (pml4_is_dirty(pml4, page->va))
 	{
 		//printf("파일 변경 됐으니까 바꿔줘야지\n");
-		file_write_at(file_page->file, page->va, file_page->read_bytes, file_page->ofs);
-		pml4_set_dirty(thread_current()->pml4, page->va, 0);
+		file_write_at(file_page->file, page->frame->kva, file_page->read_bytes, file_page->ofs);
+		pml4_set_dirty(pml4, page->va, 0);
 	}
 	page->frame->page = NULL;
 	page->frame = NULL;
-	pml4_clear_page(thread_current()->pml4, page->va);
 	return true;
 
 }
@@ -85,17 +91,33 @@ file_backed_swap_out (struct page *page) {
 static void file_backed_destroy (struct page *page) {
 
 	struct file_page *file_page UNUSED = &page->file;
+	struct frame *frame;
+	int remaining;
+
+	vm_unlock_page(page);
 
-	if (pml4_is_dirty(thread_current()->pml4, page->va))
+	/* 진행 중인 축출이 있으면 끝날 때까지 기다린 뒤 프레임에서 뗀다.
+	   축출이 끝났다면 내용은 이미 파일에 쓰여 있다. */
+	remaining = vm_frame_detach(page, &frame);
+	if (frame == NULL)
+		return;
+
+	if (pml4_is_dirty(page->pml4, page->va))
 	{
 		//printf("파일 변경 됐으니까 바꿔줘야지\n");
-		if(file_write_at(file_page->file, page->va, file_page->read_bytes, file_page->ofs) <= 0){
+		if(file_write_at(file_page->file, frame->kva, file_page->read_bytes, file_page->ofs) <= 0){
 				//printf("쓰인게 없다는데 맞아?\n");
 		}
-		pml4_set_dirty(thread_current()->pml4, page->va, 0);
+		pml4_set_dirty(page->pml4, page->va, 0);
 	}
-	pml4_clear_page(thread_current()->pml4, page->va);
+	pml4_clear_page(page->pml4, page->va);
 
+	/* 매핑을 지웠으므로 pml4_destroy()는 이 프레임을 해제하지 않는다.
+	   공유하던 마지막 페이지라면 여기서 해제한다. */
+	if (remaining == 0) {
+		palloc_free_page(frame->kva);
+		vm_free_frame(frame);
+	}
 }
 
 // bool load_file(struct page *page, void *aux)
@@ -146,6 +168,7 @@ bool load_file (struct page *page, void *aux) {
 	off_t offset = fp->ofs;
     size_t page_read_bytes = fp->read_bytes;
     size_t page_zero_bytes = fp->zero_bytes;
+	bool text = fp->text;
 
 	free(aux);
 
@@ -153,7 +176,8 @@ bool load_file (struct page *page, void *aux) {
         .file = file,
         .ofs = offset,
         .read_bytes = page_read_bytes,
-        .zero_bytes = page_zero_bytes
+        .zero_bytes = page_zero_bytes,
+        .text = text
     };
 
 	void *kpage = page->frame->kva;
@@ -195,6 +219,7 @@ void *do_mmap (void *addr, size_t length, int writable, struct file *file, off_t
 		file_page->ofs = offset;
 		file_page->read_bytes = page_read_bytes;
 		file_page->zero_bytes = page_zero_bytes;
+		file_page->text = false;
 
 		// vm_alloc_page_with_initializer를 호출하여 대기 중인 객체를 생성합니다.
 		if (!vm_alloc_page_with_initializer(VM_FILE, addr, writable, load_file, file_page)){
@@ -1,5 +1,9 @@
 /* vm.c: Generic interface for virtual memory objects. */
 
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "threads/interrupt.h"
 #include "threads/malloc.h"
 #include "threads/mmu.h"
 #include "vm/vm.h"
@@ -10,6 +14,112 @@
 static struct list frame_list;
 static struct lock frame_lock;
 
+/* Broadcast, with FRAME_LOCK held, when a frame's last pin is
+ * released or an eviction finishes, to wake threads waiting for a
+ * frame to become stable. */
+static struct condition frame_cond;
+
+/* Clock hand: the next frame in frame_list that vm_get_victim()
+ * examines, or the list end to start over from the front.  The hand
+ * keeps its place between evictions, so each frame is visited once
+ * per revolution rather than once per eviction. */
+static struct list_elem *clock_hand;
+static size_t frame_cnt;        /* Number of frames in frame_list. */
+
+/* Page-out daemon.  kswapd sleeps until the number of free user
+ * frames falls below the low watermark, then evicts pages until the
+ * high watermark is reached, so that page faults normally find a
+ * free frame without evicting one themselves.  A low watermark of 0
+ * disables the daemon.  Both are set with -kswapd=LOW,HIGH. */
+#define KSWAPD_BATCH SWAP_BATCH_MAX  /* Victims chosen before writing. */
+static size_t kswapd_low = 16;
+static size_t kswapd_high = 32;
+static struct semaphore kswapd_sema;
+static bool kswapd_awake;
+
+static void kswapd (void *aux);
+static void kswapd_wakeup (void);
+
+/* Shared zero page.  A read fault on an anonymous page that has
+ * never been written maps this single read-only page of zeros
+ * instead of giving the page a frame of its own.  The page stays
+ * uninitialized, and the first write to it faults again and claims
+ * a private frame.  The zero page comes from the kernel pool, so it
+ * is never in frame_list and never evicted. */
+static void *zero_page;
+static long long zero_maps;     /* Read faults served by zero_page. */
+
+static bool page_is_zero_fill (struct page *page);
+
+/* Pre-zeroed frame pool.  The idle thread takes free user pages and
+ * clears them ahead of time, so that a fault on a page that starts
+ * out as all zeros gets a frame without clearing one on the spot.
+ * The pool is only filled while free memory is above kswapd's high
+ * watermark, and kswapd empties it before evicting anything.  The
+ * idle thread must never block, so the pool is protected by
+ * disabling interrupts rather than by a lock. */
+#define ZERO_POOL_MAX 16
+static void *zero_pool[ZERO_POOL_MAX];
+static size_t zero_pool_cnt;
+static long long zero_pool_hits;   /* Zero-fill claims served by the pool. */
+static long long zero_pool_misses; /* Zero-fill claims that cleared a page. */
+
+static void *zero_pool_get (void);
+static void zero_pool_drain (void);
+
+/* Fault-around.  A fault on a page that is loaded from a file, an
+ * mmap page or a lazily loaded executable segment, also loads the
+ * other not-yet-loaded pages in the same aligned window of
+ * FAULT_AROUND_PAGES pages that continue the same run of the file.
+ * The whole run is read with one file_read_at() into physically
+ * contiguous frames.  Read-only executable pages, i.e. program text,
+ * are mapped at once, so program startup takes one fault per window
+ * instead of one per page; writable data pages are still loaded one
+ * by one, as they are touched.  The neighbours of an mmap page are
+ * left loaded but unmapped, since a mapping's untouched pages must
+ * stay unmapped; touching one later only has to map it, with no I/O.
+ * The extra frames are only taken while free memory is above
+ * kswapd's low watermark. */
+#define FAULT_AROUND_PAGES 8
+static long long fault_around_faults;  /* Faults that loaded a window. */
+static long long fault_around_pages;   /* Extra pages those loaded. */
+
+static bool vm_fault_around (struct page *page, bool *mapped);
+static bool vm_load_run (struct page *pages[], size_t cnt, bool map_all,
+		struct page *target, bool *mapped);
+
+/* Largest run of pages vm_populate() reads at once. */
+#define POPULATE_PAGES 16
+
+/* Pages locked with MAP_LOCKED may take at most 1/LOCKED_FRACTION of
+ * the user frames, so that eviction always has frames to choose
+ * from.  LOCKED_CNT is protected by FRAME_LOCK. */
+#define LOCKED_FRACTION 4
+static size_t locked_cnt;
+
+static bool locked_reserve (size_t cnt);
+static void locked_release (size_t cnt);
+
+/* Text page cache.  Read-only pages of executables are file pages,
+ * and a frame holding one is entered in TEXT_CACHE under its file's
+ * inode and offset.  A process that faults on the same page of the
+ * same executable maps the cached frame instead of reading a copy of
+ * its own, so all the processes running a program share one copy of
+ * its text; the frame's sharers and ref_cnt track them.  Text frames
+ * are never written, so evicting one just unmaps it from every
+ * sharer and drops it from the cache.  Protected by FRAME_LOCK. */
+static struct hash text_cache;
+static long long text_shared;   /* Faults served from text_cache. */
+
+static uint64_t text_hash (const struct hash_elem *, void *);
+static bool text_less (const struct hash_elem *, const struct hash_elem *,
+		void *);
+static struct file_page *page_text_source (struct page *page);
+static bool text_cached (struct page *page);
+static void text_cache_add (struct frame *frame, struct page *page);
+static void text_cache_evict (struct frame *frame);
+static bool vm_map_text (struct page *page, bool *mapped);
+
 #define USER_STACK_LIMIT (1 << 20)
 
 /* Initializes the virtual memory subsystem by invoking each subsystem's
@@ -26,7 +136,48 @@ vm_init (void) {
 	/* TODO: Your code goes here. */
 	list_init(&frame_list);
 	lock_init(&frame_lock);
+	cond_init (&frame_cond);
+	hash_init (&text_cache, text_hash, text_less, NULL);
+	clock_hand = list_end (&frame_list);
+
+	zero_page = palloc_get_page (PAL_ZERO);
+	if (zero_page == NULL)
+		PANIC ("out of memory for zero page");
+
+	sema_init (&kswapd_sema, 0);
+	if (kswapd_low > 0)
+		thread_create ("kswapd", PRI_DEFAULT, kswapd, NULL);
+}
+
+/* Sets the page-out daemon's watermarks from VALUE, given as
+ * "LOW,HIGH".  Returns false if VALUE is malformed or LOW exceeds
+ * HIGH. */
+bool
+vm_set_watermarks (const char *value) {
+	const char *comma = strchr (value, ',');
+	int low, high;
+
+	if (comma == NULL)
+		return false;
+	low = atoi (value);
+	high = atoi (comma + 1);
+	if (low < 0 || high < low)
+		return false;
+	kswapd_low = low;
+	kswapd_high = high;
+	return true;
+}
 
+/* Prints paging statistics. */
+void
+vm_print_stats (void) {
+	printf ("Zero page: %lld read faults\n", zero_maps);
+	printf ("Zero pool: %lld hits, %lld misses\n",
+			zero_pool_hits, zero_pool_misses);
+	printf ("Fault-around: %lld faults, %lld extra pages\n",
+			fault_around_faults, fault_around_pages);
+	printf ("Text: %lld faults mapped a shared page\n", text_shared);
+	anon_print_stats ();
 }
 
 /* Get the type of the page. This function is useful if you want to know the
@@ -47,6 +198,14 @@ page_get_type (struct page *page) {
 static struct frame *vm_get_victim (void);
 static bool vm_do_claim_page (struct page *page);
 static struct frame *vm_evict_frame (void);
+static void vm_frame_attach (struct frame *frame, struct page *page);
+static bool vm_protect_page (struct page *page, void *kva, bool writable);
+static int frame_detach (struct frame *frame, struct page *page);
+static bool vm_map_resident (struct page *page, bool *mapped);
+static struct frame *frame_create (void *kva);
+static void frame_unpin (struct frame *frame);
+static bool vm_fork_copy (struct page *dst, void *kva);
+static void unpin_pages (const void *start, const void *end);
 
 /* 초기화 프로그램과 함께 보류 중인 페이지 객체를 생성합니다. 페이지를 생성하려면 이 함수 또는
 vm_alloc_page를 통해 직접 만들지 않고 생성해야 합니다. */
@@ -89,6 +248,7 @@ vm_alloc_page_with_initializer (enum vm_type type, void *upage, bool writable,
 		uninit_new(p, upage, init, type, aux, page_initializer);
 		
 		p->writable = writable;
+		p->pml4 = thread_current ()->pml4;
 
 		// if (spt_insert_page(spt, p)){
 		// 	// printf("insert success\n");
@@ -174,28 +334,92 @@ spt_remove_page (struct supplemental_page_table *spt, struct page *page) {
 	return true;
 }
 
+/* Returns the frame under the clock hand and advances the hand,
+ * wrapping around at the end of frame_list.  FRAME_LOCK must be held
+ * and the list must not be empty. */
+static struct frame *
+clock_next (void) {
+	struct frame *f;
+
+	if (clock_hand == list_end (&frame_list))
+		clock_hand = list_begin (&frame_list);
+	f = list_entry (clock_hand, struct frame, f_elem);
+	clock_hand = list_next (clock_hand);
+	return f;
+}
+
+/* Returns true if any page mapping F was accessed since the last
+ * check, clearing the accessed bits in every owner's page table. */
+static bool
+frame_test_and_clear_accessed (struct frame *f) {
+	bool accessed = false;
+	struct list_elem *e;
+
+	for (e = list_begin (&f->sharers); e != list_end (&f->sharers);
+			e = list_next (e)) {
+		struct page *p = list_entry (e, struct page, share_elem);
+		if (pml4_is_accessed (p->pml4, p->va)) {
+			pml4_set_accessed (p->pml4, p->va, false);
+			accessed = true;
+		}
+	}
+	return accessed;
+}
+
+/* Returns true if any page mapping F has been written through its
+ * owner's page table. */
+static bool
+frame_is_dirty (struct frame *f) {
+	struct list_elem *e;
+
+	for (e = list_begin (&f->sharers); e != list_end (&f->sharers);
+			e = list_next (e)) {
+		struct page *p = list_entry (e, struct page, share_elem);
+		if (pml4_is_dirty (p->pml4, p->va))
+			return true;
+	}
+	return false;
+}
+
 /* Get the struct frame, that will be evicted. */
 static struct frame *
 vm_get_victim (void) {
 	struct frame *victim = NULL;
 	 /* TODO: The policy for eviction is up to you. */
-	struct list_elem *e;
-	lock_acquire(&frame_lock);
+	size_t steps;
 
-	for(e = list_begin(&frame_list); e != list_end(&frame_list); e = list_next(e)){
-
-		victim = list_entry(e,struct frame, f_elem);
-		uint64_t *pml4 = thread_current()->pml4;
+	lock_acquire(&frame_lock);
 
-		if(victim->page == NULL){
-			break;
+	/* 시계 알고리즘.  accessed bit가 켜진 프레임은 비트를 지우고
+	   지나가고, 더러운 프레임은 쓰기 비용이 크므로 한 바퀴 더 기회를
+	   준다.  상태를 바꾸지 않고 지나가는 프레임이 없으므로 세 바퀴
+	   안에 반드시 고른다.  pinned 프레임은 커널이 I/O 중이므로
+	   내보내지 않는다.  공유 코드 프레임은 모든 공유자에게서 떼어
+	   내고, 여러 프로세스가 공유하는 copy-on-write 익명 프레임은 모든
+	   공유자가 하나의 스왑 슬롯을 가리키게 하고 내보낸다.  공유하는
+	   파일 매핑 프레임은 내보내지 않는다. */
+	for (steps = 0; steps < 3 * frame_cnt; steps++) {
+		struct frame *f = clock_next ();
+
+		if (f->pinned > 0 || f->page == NULL
+				|| (f->ref_cnt > 1 && f->inode == NULL
+					&& f->page->operations->type != VM_ANON))
+			continue;
+
+		if (frame_test_and_clear_accessed (f)) {
+			f->spared = false;
+			continue;
 		}
-
-		if(pml4_is_accessed(pml4,victim->page->va)){
-			pml4_set_accessed(pml4,victim->page->va,0);
-		}else{
-			break;
+		if (!f->spared && frame_is_dirty (f)) {
+			f->spared = true;
+			continue;
 		}
+		victim = f;
+		break;
+	}
+	if (victim != NULL) {
+		victim->pinned++;
+		victim->evicting = true;
 	}
 
 	lock_release(&frame_lock);
@@ -203,25 +427,110 @@ vm_get_victim (void) {
 	return victim;
 }
 
+/* Writes the pages held by the CNT frames in VICTIMS, each returned
+ * by vm_get_victim(), out to their backing store, and leaves the
+ * frames empty and still pinned.  Anonymous pages are written
+ * together to a run of consecutive swap slots. */
+static void
+vm_swap_out_frames (struct frame *victims[], size_t cnt) {
+	struct page *anon[SWAP_BATCH_MAX];
+	size_t anon_cnt = 0, i;
+
+	ASSERT (cnt <= SWAP_BATCH_MAX);
+
+	for (i = 0; i < cnt; i++) {
+		struct page *page = victims[i]->page;
+
+		if (page == NULL)
+			continue;
+		if (page->operations->type == VM_ANON)
+			anon[anon_cnt++] = page;
+		else if (victims[i]->inode != NULL)
+			text_cache_evict (victims[i]);
+		else
+			// 어디로 가는거냐고
+			swap_out(page);
+	}
+	if (anon_cnt > 0)
+		anon_swap_out_batch (anon, anon_cnt);
+
+	lock_acquire (&frame_lock);
+	for (i = 0; i < cnt; i++) {
+		struct frame *victim = victims[i];
+
+		victim->page = NULL;
+		list_init (&victim->sharers);
+		victim->ref_cnt = 0;
+		victim->spared = false;
+		victim->evicting = false;
+	}
+	cond_broadcast (&frame_cond, &frame_lock);
+	lock_release (&frame_lock);
+}
+
 /* Evict one page and return the corresponding frame.
  * Return NULL on error.*/
 static struct frame *
 vm_evict_frame (void) {
 	struct frame *victim UNUSED = vm_get_victim ();
 	/* TODO: swap out the victim and return the evicted frame. */
-	if (victim->page != NULL){
-		// 어디로 가는거냐고
-        swap_out(victim->page);
-	}
+	if (victim == NULL)
+		return NULL;
+	vm_swap_out_frames (&victim, 1);
 
 	return victim;
 }
 
+/* Wakes kswapd if it is asleep. */
+static void
+kswapd_wakeup (void) {
+	if (kswapd_low > 0 && !kswapd_awake) {
+		kswapd_awake = true;
+		sema_up (&kswapd_sema);
+	}
+}
+
+/* Body of the page-out daemon. */
+static void
+kswapd (void *aux UNUSED) {
+	for (;;) {
+		sema_down (&kswapd_sema);
+
+		for (;;) {
+			struct frame *batch[KSWAPD_BATCH];
+			size_t free_cnt = palloc_free_cnt (PAL_USER);
+			size_t cnt = 0, i;
+
+			if (free_cnt >= kswapd_high)
+				break;
+			if (zero_pool_cnt > 0) {
+				zero_pool_drain ();
+				continue;
+			}
+
+			/* Choose a batch of victims first, so that their anonymous
+			 * pages go to swap in one sequential transfer. */
+			while (cnt < KSWAPD_BATCH && cnt < kswapd_high - free_cnt
+					&& (batch[cnt] = vm_get_victim ()) != NULL)
+				cnt++;
+			if (cnt == 0)
+				break;
+
+			vm_swap_out_frames (batch, cnt);
+			for (i = 0; i < cnt; i++) {
+				palloc_free_page (batch[i]->kva);
+				vm_free_frame (batch[i]);
+			}
+		}
+		kswapd_awake = false;
+	}
+}
+
 /* palloc()을 사용하여 프레임을 가져옵니다. 
 사용 가능한 페이지가 없으면 페이지를 추방(evict)하고 반환합니다.
 이 함수는 항상 유효한 주소를 반환합니다. 즉, 사용자 풀 메모리가 가득 찬 경우, 
 이 함수는 프레임을 추방하여 사용 가능한 메모리 공간을 얻습니다. */
-static struct frame * vm_get_frame (void) {
+static struct frame * vm_get_frame (bool zero) {
 	
 	// struct frame *frame = NULL;
 	// /* TODO: Fill this function. */
@@ -250,31 +559,157 @@ static struct frame * vm_get_frame (void) {
 
 	struct frame *frame = NULL;
 	/* TODO: Fill this function. */
-	void *kva = palloc_get_page(PAL_USER | PAL_ZERO);
+	void *kva = NULL;
+
+	/* 0으로 채워야 하는 페이지는 미리 지워 둔 페이지를 먼저 쓴다. */
+	if (zero) {
+		kva = zero_pool_get ();
+		if (kva != NULL)
+			zero_pool_hits++;
+		else
+			zero_pool_misses++;
+	}
+	if (kva == NULL)
+		kva = palloc_get_page(PAL_USER | (zero ? PAL_ZERO : 0));
+	if (kva == NULL)
+		kva = zero_pool_get ();
+
+	if (palloc_free_cnt (PAL_USER) < kswapd_low)
+		kswapd_wakeup ();
 	
 	if(kva == NULL){
-		/* while(frame == NULL){// 항상 유효한 주소를 반환해야함
-			frame = vm_evict_frame();
-		} */
-		frame = vm_evict_frame();
-		memset(frame->kva, 0, PGSIZE);
+		/* kswapd가 내보낼 수 있는 프레임을 모두 묶음으로 고정하고
+		   쓰는 중이면 고를 희생자가 없다.  묶음이 끝나 프레임이
+		   풀리거나 다시 고를 수 있을 때까지 양보하며 기다린다. */
+		while ((frame = vm_evict_frame ()) == NULL) {
+			thread_yield ();
+			kva = palloc_get_page (PAL_USER | (zero ? PAL_ZERO : 0));
+			if (kva != NULL)
+				break;
+		}
+	}
+	if (frame != NULL) {
+		if (zero)
+			memset(frame->kva, 0, PGSIZE);
 		frame->page = NULL;
 		return frame;
 	}
-	frame = (struct frame *)malloc(sizeof(struct frame));
+	frame = frame_create(kva);
+
+	ASSERT(frame != NULL);
+    ASSERT(frame->kva != NULL);
+    ASSERT(frame->page == NULL);
+
+	return frame;
+	 
+}
+
+/* Called by the idle thread whenever it runs.  Tops up the
+ * pre-zeroed frame pool.  The page is allocated with interrupts
+ * disabled, so that the idle thread is never preempted while holding
+ * the allocator's lock, and cleared with interrupts enabled. */
+void
+vm_idle (void) {
+	enum intr_level old_level;
+	void *kva;
+
+	for (;;) {
+		old_level = intr_disable ();
+		if (zero_pool_cnt >= ZERO_POOL_MAX
+				|| palloc_free_cnt (PAL_USER) <= kswapd_high) {
+			intr_set_level (old_level);
+			return;
+		}
+		kva = palloc_get_page (PAL_USER);
+		intr_set_level (old_level);
+		if (kva == NULL)
+			return;
+
+		memset (kva, 0, PGSIZE);
+
+		/* Only the idle thread adds to the pool, so there is still
+		 * room for KVA. */
+		old_level = intr_disable ();
+		zero_pool[zero_pool_cnt++] = kva;
+		intr_set_level (old_level);
+	}
+}
+
+/* Takes a page from the pre-zeroed pool.  Returns a null pointer if
+ * the pool is empty. */
+static void *
+zero_pool_get (void) {
+	enum intr_level old_level = intr_disable ();
+	void *kva = zero_pool_cnt > 0 ? zero_pool[--zero_pool_cnt] : NULL;
+	intr_set_level (old_level);
+	return kva;
+}
+
+/* Returns every page in the pre-zeroed pool to the user pool. */
+static void
+zero_pool_drain (void) {
+	void *kva;
+
+	while ((kva = zero_pool_get ()) != NULL)
+		palloc_free_page (kva);
+}
+
+/* Wraps KVA, a page from the user pool, in a new frame and adds it
+ * to the frame table. */
+static struct frame *
+frame_create (void *kva) {
+	struct frame *frame = (struct frame *)malloc(sizeof(struct frame));
+	if (frame == NULL)
+		PANIC ("out of memory for frame table");
 	frame->kva = kva;
 	frame->page = NULL;
+	list_init (&frame->sharers);
+	frame->ref_cnt = 0;
+	frame->spared = false;
+	frame->evicting = false;
+	frame->inode = NULL;
+	/* 페이지 내용이 채워질 때까지 축출되지 않도록 고정한다.
+	   vm_do_claim_page()가 swap_in을 마친 뒤 해제한다. */
+	frame->pinned = 1;
 
 	lock_acquire(&frame_lock);
 	list_push_back(&frame_list,&frame->f_elem);
+	frame_cnt++;
 	lock_release(&frame_lock);
+	return frame;
+}
 
-	ASSERT(frame != NULL);
-    ASSERT(frame->kva != NULL);
-    ASSERT(frame->page == NULL);
+/* Releases one pin on FRAME, waking waiters if it was the last.
+ * FRAME_LOCK must be held. */
+static void
+frame_unpin (struct frame *frame) {
+	ASSERT (frame->pinned > 0);
+	if (--frame->pinned == 0)
+		cond_broadcast (&frame_cond, &frame_lock);
+}
 
-	return frame;
-	 
+/* Returns a pinned frame for speculative use, such as swap
+ * readahead, or a null pointer if that would leave fewer free user
+ * frames than kswapd's low watermark.  Never evicts. */
+struct frame *
+vm_get_spare_frame (void) {
+	void *kva;
+
+	if (palloc_free_cnt (PAL_USER) <= kswapd_low)
+		return NULL;
+	kva = palloc_get_page (PAL_USER);
+	return kva != NULL ? frame_create (kva) : NULL;
+}
+
+/* Gives FRAME, filled with PAGE's contents by swap readahead, to
+ * PAGE without mapping it.  The next fault on PAGE maps the frame;
+ * until then it may be evicted like any other. */
+void
+vm_stage_page (struct frame *frame, struct page *page) {
+	vm_frame_attach (frame, page);
+	lock_acquire (&frame_lock);
+	frame_unpin (frame);
+	lock_release (&frame_lock);
 }
 
 /* Growing the stack. */
@@ -288,13 +723,62 @@ vm_stack_growth (void *addr UNUSED) {
 
 /* Handle the fault on write_protected page */
 static bool
-vm_handle_wp (struct page *page UNUSED) {
+vm_handle_wp (struct page *page) {
+	struct frame *old;
+	struct frame *new;
+	int remaining;
+
+	/* 폴트 이후 축출되었거나 축출 중이라면 다시 접근할 때 새로 읽어 온다.
+	   마지막으로 남은 페이지라면 복사 없이 쓰기 권한만 되돌린다. */
+	lock_acquire (&frame_lock);
+	old = page->frame;
+	if (old == NULL || old->evicting) {
+		lock_release (&frame_lock);
+		return true;
+	}
+	if (old->ref_cnt == 1) {
+		bool success = vm_protect_page (page, old->kva, true);
+		lock_release (&frame_lock);
+		return success;
+	}
+	old->pinned++;
+	lock_release (&frame_lock);
+
+	/* 공유를 끊고 이 프로세스만의 사본을 만든다. */
+	new = vm_get_frame (false);
+	memcpy (new->kva, old->kva, PGSIZE);
+	if (!pml4_set_page (page->pml4, page->va, new->kva, true)) {
+		lock_acquire (&frame_lock);
+		frame_unpin (old);
+		lock_release (&frame_lock);
+		palloc_free_page (new->kva);
+		vm_free_frame (new);
+		return false;
+	}
+
+	lock_acquire (&frame_lock);
+	remaining = frame_detach (old, page);
+	lock_release (&frame_lock);
+	vm_frame_attach (new, page);
+	lock_acquire (&frame_lock);
+	frame_unpin (old);
+	frame_unpin (new);
+	lock_release (&frame_lock);
+
+	/* 그 사이 다른 공유자가 모두 사라졌다면 옛 프레임은 아무도
+	   매핑하지 않으므로 직접 해제한다. */
+	if (remaining == 0) {
+		palloc_free_page (old->kva);
+		vm_free_frame (old);
+	}
+	return true;
 }
 
 /* Return true on success */
 bool vm_try_handle_fault (struct intr_frame *f UNUSED, void *addr UNUSED,bool user UNUSED, bool write UNUSED, bool not_present UNUSED) {
 	struct supplemental_page_table *spt UNUSED = &thread_current()->spt;
 	struct page *page = NULL;
+	bool mapped;
 
 	if (addr == NULL)
 		return false;
@@ -327,11 +811,435 @@ bool vm_try_handle_fault (struct intr_frame *f UNUSED, void *addr UNUSED,bool us
 			return false;
 		if (write && !page->writable) // write 불가능한 페이지에 write 요청한 경우
 			return false;
+		if (vm_map_resident(page, &mapped))
+			return mapped;
+		if (!write && page_is_zero_fill(page)) {
+			zero_maps++;
+			return pml4_set_page(page->pml4, page->va, zero_page, false);
+		}
+		if (vm_map_text(page, &mapped))
+			return mapped;
+		if (vm_fault_around(page, &mapped))
+			return mapped;
 		return vm_do_claim_page(page);
 	}
+
+	/* 존재하는 페이지에 대한 쓰기 폴트는 copy-on-write 공유이거나
+	   공유 제로 페이지에 대한 첫 쓰기 때문이다. */
+	if (!write)
+		return false;
+	page = spt_find_page(spt, pg_round_down(addr));
+	if (page == NULL || !page->writable)
+		return false;
+	if (page->frame == NULL)
+		return page_is_zero_fill(page) && vm_do_claim_page(page);
+	return vm_handle_wp(page);
+}
+
+/* Handles a not-present fault on PAGE when PAGE may already have a
+ * frame.  The evictor unmaps a page before writing it out, so the
+ * owner can fault on it while the write is under way; waits for the
+ * eviction to finish in that case.  Swap readahead leaves pages in
+ * frames without mapping them; maps such a frame now.  Returns false
+ * if PAGE has no frame and still has to be claimed.  Otherwise stores
+ * into *MAPPED whether mapping the frame succeeded and returns
+ * true. */
+static bool
+vm_map_resident (struct page *page, bool *mapped) {
+	lock_acquire (&frame_lock);
+	while (page->frame != NULL && page->frame->evicting)
+		cond_wait (&frame_cond, &frame_lock);
+	if (page->frame == NULL) {
+		lock_release (&frame_lock);
+		return false;
+	}
+	if (page->operations->type == VM_ANON)
+		anon_unstage (page);
+	*mapped = pml4_set_page (page->pml4, page->va, page->frame->kva,
+			page->writable && page->frame->ref_cnt == 1);
+	lock_release (&frame_lock);
+	return true;
+}
+
+/* Returns true if PAGE is an anonymous page that has never been
+ * touched and whose contents are all zeros, such as a stack or BSS
+ * page. */
+static bool
+page_is_zero_fill (struct page *page) {
+	return page->operations->type == VM_UNINIT
+		&& VM_TYPE (page->uninit.type) == VM_ANON
+		&& page->uninit.init == NULL;
+}
+
+/* Returns the description of where PAGE, an uninitialized page, is
+ * loaded from if it is loaded from a file, otherwise a null
+ * pointer. */
+static struct file_page *
+page_file_source (struct page *page) {
+	if (page->operations->type != VM_UNINIT)
+		return NULL;
+	if (page->uninit.init != load_file && page->uninit.init != lazy_load_segment)
+		return NULL;
+	return page->uninit.aux;
+}
+
+/* Returns true if HI, the page after LO, is loaded from the part of
+ * the same file right after the part LO is loaded from. */
+static bool
+pages_contiguous (struct page *lo, struct page *hi) {
+	struct file_page *a = page_file_source (lo);
+	struct file_page *b = page_file_source (hi);
+
+	return a != NULL && b != NULL && lo->uninit.init == hi->uninit.init
+		&& lo->writable == hi->writable
+		&& a->file == b->file && a->read_bytes == PGSIZE
+		&& b->ofs == a->ofs + PGSIZE;
+}
+
+/* Initializes PAGE, an uninitialized page loaded from a file whose
+ * contents the caller has already read into KVA, the way its
+ * initializer would have. */
+static bool
+vm_init_loaded_page (struct page *page, void *kva) {
+	struct uninit_page uninit = page->uninit;
+	struct file_page *fp = uninit.aux;
+
+	if (!uninit.page_initializer (page, uninit.type, kva))
+		return false;
+	if (VM_TYPE (uninit.type) == VM_FILE)
+		page->file = *fp;
+	free (fp);
+	return true;
+}
+
+/* Handles a not-present fault on PAGE with fault-around.  Returns
+ * false if PAGE is not loaded from a file, no neighbouring page can
+ * be loaded along with it, or memory for the window is short; PAGE
+ * must then be claimed alone.  Otherwise stores into *MAPPED whether
+ * PAGE was loaded and mapped and returns true.  A neighbour that
+ * cannot be mapped is left loaded in its frame, and mapped by
+ * vm_map_resident() when it faults. */
+static bool
+vm_fault_around (struct page *page, bool *mapped) {
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+	struct page *pages[FAULT_AROUND_PAGES];
+	uintptr_t window = FAULT_AROUND_PAGES * PGSIZE;
+	void *lo = (void *) ((uintptr_t) page->va & ~(window - 1));
+	struct page *start = page;
+	size_t cnt;
+
+	if (page_file_source (page) == NULL
+			|| (page->uninit.init == lazy_load_segment && page->writable))
+		return false;
+
+	/* Text pages another process already loaded are mapped from the
+	 * text cache when they fault, so they are not read again. */
+	while (start->va > lo) {
+		struct page *prev = spt_find_page (spt, start->va - PGSIZE);
+		if (prev == NULL || !pages_contiguous (prev, start) || text_cached (prev))
+			break;
+		start = prev;
+	}
+	pages[0] = start;
+	cnt = 1;
+	while (pages[cnt - 1]->va + PGSIZE < lo + window) {
+		struct page *next = spt_find_page (spt, pages[cnt - 1]->va + PGSIZE);
+		if (next == NULL || !pages_contiguous (pages[cnt - 1], next)
+				|| text_cached (next))
+			break;
+		pages[cnt++] = next;
+	}
+	if (cnt == 1 || !vm_load_run (pages, cnt, page_file_source (page)->text,
+				page, mapped))
+		return false;
+	fault_around_faults++;
+	fault_around_pages += cnt - 1;
+	return true;
+}
+
+/* Loads the CNT pages in PAGES, uninitialized pages that continue
+ * one another in the same file, with a single read into physically
+ * contiguous frames.  Maps TARGET, and the other pages too if
+ * MAP_ALL.  Returns false, leaving the pages untouched, if the read
+ * fails or the frames would leave fewer free user frames than
+ * kswapd's low watermark.  Otherwise returns true and, if TARGET is
+ * one of PAGES, stores into *MAPPED whether it was mapped.  A page
+ * that is not mapped is left loaded in its frame, and
+ * vm_map_resident() maps it when it faults. */
+static bool
+vm_load_run (struct page *pages[], size_t cnt, bool map_all,
+		struct page *target, bool *mapped) {
+	struct file_page *first = page_file_source (pages[0]);
+	size_t read_bytes, i;
+	uint8_t *kva;
+
+	if (palloc_free_cnt (PAL_USER) < kswapd_low + cnt)
+		return false;
+	kva = palloc_get_multiple (PAL_USER, cnt);
+	if (kva == NULL)
+		return false;
+
+	read_bytes = (cnt - 1) * PGSIZE + page_file_source (pages[cnt - 1])->read_bytes;
+	if (file_read_at (first->file, kva, read_bytes, first->ofs)
+			!= (int) read_bytes) {
+		palloc_free_multiple (kva, cnt);
+		return false;
+	}
+	memset (kva + read_bytes, 0, cnt * PGSIZE - read_bytes);
+
+	for (i = 0; i < cnt; i++) {
+		struct frame *frame = frame_create (kva + i * PGSIZE);
+		struct page *p = pages[i];
+		bool success;
+
+		vm_frame_attach (frame, p);
+		success = vm_init_loaded_page (p, frame->kva);
+		if (success && (map_all || p == target))
+			success = pml4_set_page (p->pml4, p->va, frame->kva, p->writable);
+		if (success)
+			text_cache_add (frame, p);
+		if (p == target)
+			*mapped = success;
+		lock_acquire (&frame_lock);
+		frame_unpin (frame);
+		lock_release (&frame_lock);
+	}
+	return true;
+}
+
+/* Loads every page of the mapping of LENGTH bytes at ADDR, which
+ * do_mmap() has just created, reading each run of up to
+ * POPULATE_PAGES pages of the file with one large read.  Pages that
+ * cannot be loaded that way are claimed one at a time.  With LOCK,
+ * also pins the pages so that they are never evicted; they stay
+ * pinned until they are unmapped.  Returns false if a page cannot be
+ * loaded, or if locking the pages would exceed the limit on locked
+ * pages. */
+bool
+vm_populate (void *addr, size_t length, bool lock) {
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+	void *end = addr + length;
+	size_t page_cnt = (pg_round_up (end) - addr) / PGSIZE;
+	void *va;
+
+	if (lock && !locked_reserve (page_cnt))
+		return false;
+
+	for (va = addr; va < end; ) {
+		struct page *pages[POPULATE_PAGES];
+		size_t cnt = 0, i;
+
+		pages[cnt] = spt_find_page (spt, va);
+		if (pages[cnt] == NULL)
+			break;
+		cnt++;
+		while (cnt < POPULATE_PAGES && va + cnt * PGSIZE < end) {
+			struct page *next = spt_find_page (spt, va + cnt * PGSIZE);
+			if (next == NULL || !pages_contiguous (pages[cnt - 1], next))
+				break;
+			pages[cnt++] = next;
+		}
+		if (cnt == 1 || !vm_load_run (pages, cnt, true, NULL, NULL))
+			for (i = 0; i < cnt; i++)
+				if (pages[i]->frame == NULL && !vm_do_claim_page (pages[i]))
+					goto fail;
+		va += cnt * PGSIZE;
+	}
+
+	if (lock) {
+		if (!vm_pin_range (addr, length))
+			goto fail;
+		for (va = addr; va < end; va += PGSIZE) {
+			struct page *page = spt_find_page (spt, va);
+			if (page != NULL)
+				page->locked = true;
+			else
+				locked_release (1);
+		}
+	}
+	return true;
+
+fail:
+	if (lock)
+		locked_release (page_cnt);
 	return false;
 }
 
+/* Counts CNT more pages as locked.  Returns false, counting none,
+ * if that would exceed the limit on locked pages. */
+static bool
+locked_reserve (size_t cnt) {
+	size_t limit;
+	bool success;
+
+	lock_acquire (&frame_lock);
+	limit = (frame_cnt + palloc_free_cnt (PAL_USER)) / LOCKED_FRACTION;
+	success = locked_cnt + cnt <= limit;
+	if (success)
+		locked_cnt += cnt;
+	lock_release (&frame_lock);
+	return success;
+}
+
+/* Stops counting CNT pages as locked. */
+static void
+locked_release (size_t cnt) {
+	lock_acquire (&frame_lock);
+	ASSERT (locked_cnt >= cnt);
+	locked_cnt -= cnt;
+	lock_release (&frame_lock);
+}
+
+/* Unlocks PAGE, which is being unmapped, if MAP_LOCKED locked it,
+ * releasing the pin that vm_populate() took on its frame. */
+void
+vm_unlock_page (struct page *page) {
+	if (!page->locked)
+		return;
+	page->locked = false;
+	lock_acquire (&frame_lock);
+	if (page->frame != NULL && page->frame->pinned > 0)
+		frame_unpin (page->frame);
+	ASSERT (locked_cnt > 0);
+	locked_cnt--;
+	lock_release (&frame_lock);
+}
+
+/* Returns a hash value for text frame F. */
+static uint64_t
+text_hash (const struct hash_elem *f_, void *aux UNUSED) {
+	const struct frame *f = hash_entry (f_, struct frame, text_elem);
+
+	return hash_bytes (&f->inode, sizeof f->inode) ^ hash_int (f->ofs);
+}
+
+/* Returns true if text frame A precedes text frame B. */
+static bool
+text_less (const struct hash_elem *a_, const struct hash_elem *b_,
+		void *aux UNUSED) {
+	const struct frame *a = hash_entry (a_, struct frame, text_elem);
+	const struct frame *b = hash_entry (b_, struct frame, text_elem);
+
+	if (a->inode != b->inode)
+		return a->inode < b->inode;
+	return a->ofs < b->ofs;
+}
+
+/* Returns where PAGE, a text page that is not resident, loads from,
+ * or a null pointer if PAGE is not a text page. */
+static struct file_page *
+page_text_source (struct page *page) {
+	struct file_page *fp;
+
+	if (page->operations->type == VM_FILE)
+		fp = &page->file;
+	else
+		fp = page_file_source (page);
+	return fp != NULL && fp->text ? fp : NULL;
+}
+
+/* Returns the cached frame holding the text page FP describes, or a
+ * null pointer.  FRAME_LOCK must be held. */
+static struct frame *
+text_cache_find (struct file_page *fp) {
+	struct frame key;
+	struct hash_elem *e;
+
+	key.inode = file_get_inode (fp->file);
+	key.ofs = fp->ofs;
+	e = hash_find (&text_cache, &key.text_elem);
+	return e != NULL ? hash_entry (e, struct frame, text_elem) : NULL;
+}
+
+/* Returns true if PAGE is a text page whose contents are cached. */
+static bool
+text_cached (struct page *page) {
+	struct file_page *fp = page_text_source (page);
+	bool cached;
+
+	if (fp == NULL)
+		return false;
+	lock_acquire (&frame_lock);
+	cached = text_cache_find (fp) != NULL;
+	lock_release (&frame_lock);
+	return cached;
+}
+
+/* Enters FRAME, which PAGE was just loaded into, in the text cache
+ * if PAGE is a text page that is not cached yet. */
+static void
+text_cache_add (struct frame *frame, struct page *page) {
+	struct file_page *fp = page_text_source (page);
+
+	if (fp == NULL)
+		return;
+	lock_acquire (&frame_lock);
+	if (frame->inode == NULL && text_cache_find (fp) == NULL) {
+		frame->inode = file_get_inode (fp->file);
+		frame->ofs = fp->ofs;
+		hash_insert (&text_cache, &frame->text_elem);
+	}
+	lock_release (&frame_lock);
+}
+
+/* Evicts text frame FRAME, which vm_get_victim() returned: drops it
+ * from the text cache and unmaps it from every sharer.  Text pages
+ * are never dirty, so nothing is written. */
+static void
+text_cache_evict (struct frame *frame) {
+	lock_acquire (&frame_lock);
+	hash_delete (&text_cache, &frame->text_elem);
+	frame->inode = NULL;
+	while (!list_empty (&frame->sharers)) {
+		struct page *p = list_entry (list_pop_front (&frame->sharers),
+				struct page, share_elem);
+		pml4_clear_page (p->pml4, p->va);
+		p->frame = NULL;
+	}
+	lock_release (&frame_lock);
+}
+
+/* Handles a not-present fault on PAGE, a page that is not resident,
+ * by mapping its frame from the text cache.  Returns false if PAGE is
+ * not a text page or its contents are not cached.  Otherwise stores
+ * into *MAPPED whether mapping the frame succeeded and returns
+ * true. */
+static bool
+vm_map_text (struct page *page, bool *mapped) {
+	struct file_page *fp = page_text_source (page);
+	struct frame *frame;
+
+	if (fp == NULL)
+		return false;
+	lock_acquire (&frame_lock);
+	frame = text_cache_find (fp);
+	if (frame == NULL || frame->evicting) {
+		lock_release (&frame_lock);
+		return false;
+	}
+	list_push_back (&frame->sharers, &page->share_elem);
+	frame->ref_cnt++;
+	page->frame = frame;
+
+	/* 축출은 FRAME_LOCK을 잡고 시작하므로, 매핑을 마칠 때까지 잡고
+	   있으면 이 프레임이 그 사이에 내보내지지 않는다. */
+	*mapped = (page->operations->type == VM_FILE
+			|| vm_init_loaded_page (page, frame->kva))
+		&& pml4_set_page (page->pml4, page->va, frame->kva, false);
+	lock_release (&frame_lock);
+	if (*mapped)
+		text_shared++;
+	return true;
+}
+
+/* Removes PAGE's mapping of the shared zero page, if any, so that
+ * destroying PAGE's page table does not free the zero page. */
+void
+vm_unmap_zero_page (struct page *page) {
+	if (page->pml4 != NULL && pml4_get_page (page->pml4, page->va) == zero_page)
+		pml4_clear_page (page->pml4, page->va);
+}
+
 /* Free the page.
  * DO NOT MODIFY THIS FUNCTION. */
 void
@@ -368,12 +1276,11 @@ vm_claim_page (void *va UNUSED) {
 /* PAGE를 요구하고 mmu를 설정합니다. */
 static bool
 vm_do_claim_page (struct page *page) {
-	struct frame *frame = vm_get_frame ();
+	struct frame *frame = vm_get_frame (page_is_zero_fill (page));
 
 
 	/* 링크 설정 */
-	frame->page = page;
-	page->frame = frame;
+	vm_frame_attach (frame, page);
 
 	/* TODO: 페이지 테이블 항목을 삽입하여 페이지의 VA를 프레임의 PA로 매핑합니다. */
 
@@ -385,7 +1292,7 @@ vm_do_claim_page (struct page *page) {
 	// 반환 값은 작업이 성공했는지 여부를 나타내야 합니다.
 
 	/* 페이지 테이블 엔트리 삽입 */
-	if (!pml4_set_page(thread_current()->pml4, page->va, frame->kva, page->writable)) {
+	if (!pml4_set_page(page->pml4, page->va, frame->kva, page->writable)) {
 		
 		return false;
 
@@ -393,7 +1300,92 @@ vm_do_claim_page (struct page *page) {
 
 	/*------------- project 3 -------------*/
 
-	return swap_in (page, frame->kva);
+	bool success = swap_in (page, frame->kva);
+	if (success)
+		text_cache_add (frame, page);
+	lock_acquire (&frame_lock);
+	frame_unpin (frame);
+	lock_release (&frame_lock);
+	return success;
+}
+
+/* Pins every page that overlaps the user range [UADDR, UADDR + SIZE)
+ * into a frame so that the kernel can transfer data directly between
+ * the disk and the user buffer without faulting or having the frame
+ * evicted underneath it.  Pages that are not yet resident are claimed
+ * first.  Pages unknown to the SPT (e.g. stack that has not grown yet)
+ * are left to the page fault handler.
+ * Each call adds one pin to each page's frame, which is evictable
+ * again only once every pin has been released.
+ * Returns false if claiming a page fails, in which case no page is
+ * left pinned by this call. */
+bool
+vm_pin_range (const void *uaddr, size_t size) {
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+	void *upage;
+
+	if (size == 0)
+		return true;
+
+	for (upage = pg_round_down (uaddr); upage < uaddr + size;
+			upage += PGSIZE) {
+		struct page *page = spt_find_page (spt, upage);
+		if (page == NULL)
+			continue;
+
+		for (;;) {
+			lock_acquire (&frame_lock);
+			while (page->frame != NULL && page->frame->evicting)
+				cond_wait (&frame_cond, &frame_lock);
+			if (page->frame != NULL && page->writable
+					&& page->frame->ref_cnt > 1) {
+				/* The kernel may write through the pin, so break
+				 * copy-on-write sharing now rather than fault on
+				 * the frame in the middle of a transfer. */
+				lock_release (&frame_lock);
+				if (!vm_handle_wp (page)) {
+					unpin_pages (pg_round_down (uaddr), upage);
+					return false;
+				}
+				continue;
+			}
+			if (page->frame != NULL) {
+				page->frame->pinned++;
+				lock_release (&frame_lock);
+				break;
+			}
+			lock_release (&frame_lock);
+			if (!vm_do_claim_page (page)) {
+				unpin_pages (pg_round_down (uaddr), upage);
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/* Releases pins taken by vm_pin_range() on [UADDR, UADDR + SIZE). */
+void
+vm_unpin_range (const void *uaddr, size_t size) {
+	if (size > 0)
+		unpin_pages (pg_round_down (uaddr), uaddr + size);
+}
+
+/* Releases one pin from the frame of each page in [START, END).
+ * Pages without a pinned frame, such as stack that grew after the
+ * range was pinned, are skipped. */
+static void
+unpin_pages (const void *start, const void *end) {
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+	const void *upage;
+
+	lock_acquire (&frame_lock);
+	for (upage = start; upage < end; upage += PGSIZE) {
+		struct page *page = spt_find_page (spt, (void *) upage);
+		if (page != NULL && page->frame != NULL && page->frame->pinned > 0)
+			frame_unpin (page->frame);
+	}
+	lock_release (&frame_lock);
 }
 
 
@@ -408,6 +1400,112 @@ supplemental_page_table_init (struct supplemental_page_table *spt UNUSED) {
 	/*------------- project 3 -------------*/
 }
 
+/* Initializes DST, a page of a process being forked, with a private
+ * copy of the page at KVA. */
+static bool
+vm_fork_copy (struct page *dst, void *kva) {
+	struct frame *frame = vm_get_frame (false);
+	void *aux = dst->uninit.aux;
+	enum vm_type type = VM_TYPE (dst->uninit.type);
+	bool success;
+
+	memcpy (frame->kva, kva, PGSIZE);
+	vm_frame_attach (frame, dst);
+	success = dst->uninit.page_initializer (dst, dst->uninit.type, frame->kva);
+	if (type == VM_FILE)
+		free (aux);
+	success = success
+		&& pml4_set_page (dst->pml4, dst->va, frame->kva, dst->writable);
+
+	lock_acquire (&frame_lock);
+	frame_unpin (frame);
+	lock_release (&frame_lock);
+	return success;
+}
+
+/* Gives the current process, which is being forked, a copy of SRC,
+ * an initialized page of its parent.  A resident page shares SRC's
+ * frame: both page tables map it read-only and the first write to
+ * either side copies it in vm_handle_wp().  A swapped-out anonymous
+ * page is read back from SRC's swap slot into a private frame, and
+ * a file page that is not resident is left to load from the file
+ * on first access. */
+static bool
+vm_fork_page (struct page *src) {
+	enum vm_type type = page_get_type (src);
+	struct supplemental_page_table *spt = &thread_current ()->spt;
+	struct file_page *fp = NULL;
+	struct frame *frame;
+	struct page *dst;
+	void *aux;
+	bool success;
+
+	if (type == VM_FILE) {
+		fp = malloc (sizeof *fp);
+		if (fp == NULL)
+			return false;
+		*fp = src->file;
+		fp->file = src->file.text ? thread_current ()->running_file
+			: file_reopen (src->file.file);
+		if (!vm_alloc_page_with_initializer (VM_FILE, src->va,
+					src->writable, load_file, fp)) {
+			if (!fp->text)
+				file_close (fp->file);
+			free (fp);
+			return false;
+		}
+	} else if (!vm_alloc_page_with_initializer (VM_ANON, src->va,
+				src->writable, anon_copy_swapped, src))
+		return false;
+	dst = spt_find_page (spt, src->va);
+	dst->mapped_page_count = src->mapped_page_count;
+
+	/* Wait out an eviction of SRC that is already in progress.  A
+	 * locked page stays pinned for good. */
+	lock_acquire (&frame_lock);
+	while (src->frame != NULL && src->frame->pinned > 0 && !src->locked)
+		cond_wait (&frame_cond, &frame_lock);
+
+	frame = src->frame;
+	if (frame == NULL) {
+		lock_release (&frame_lock);
+		return type == VM_FILE || vm_do_claim_page (dst);
+	}
+
+	/* The lock is not inherited, and a shared frame would have to
+	 * stay pinned for the child too, so the child gets a copy. */
+	if (src->locked) {
+		lock_release (&frame_lock);
+		return vm_fork_copy (dst, frame->kva);
+	}
+
+	/* A shared frame is written to a fresh swap slot if it is
+	 * evicted, so SRC must not stay staged on its old one. */
+	if (type == VM_ANON)
+		anon_unstage (src);
+	frame->ref_cnt++;
+	list_push_back (&frame->sharers, &dst->share_elem);
+	dst->frame = frame;
+	/* Keep the frame from being evicted until both page tables map
+	 * it, since eviction unmaps only the mappings already made. */
+	frame->pinned++;
+	lock_release (&frame_lock);
+
+	aux = dst->uninit.aux;
+	success = dst->uninit.page_initializer (dst, dst->uninit.type,
+			frame->kva);
+	if (success && type == VM_FILE)
+		free (aux);
+	success = success
+		&& pml4_set_page (dst->pml4, dst->va, frame->kva, false)
+		&& (!src->writable || vm_protect_page (src, frame->kva, false));
+
+	lock_acquire (&frame_lock);
+	frame_unpin (frame);
+	lock_release (&frame_lock);
+	return success;
+}
+
 /* 보조 페이지 테이블을 src에서 dst로 복사 */
 bool supplemental_page_table_copy (struct supplemental_page_table *dst UNUSED, struct supplemental_page_table *src UNUSED) {
 		
@@ -442,33 +1540,18 @@ bool supplemental_page_table_copy (struct supplemental_page_table *dst UNUSED, s
             {
                 fp = (struct file_page *)malloc(sizeof(struct file_page));
                 struct file_page *tp = (struct file_page *)aux;
-                fp->file = real_type == VM_FILE ? file_reopen(tp->file) : tp->file;
+                fp->file = tp->text ? thread_current()->running_file
+                    : real_type == VM_FILE ? file_reopen(tp->file) : tp->file;
                 fp->ofs = tp->ofs;
                 fp->read_bytes = tp->read_bytes;
                 fp->zero_bytes = tp->zero_bytes;
+                fp->text = tp->text;
             }
 
             vm_alloc_page_with_initializer(real_type, entry->va, entry->writable, entry->uninit.init, fp);
         }
-        else if (type == VM_ANON)
-        {
-            /*
-                VM_ANON + MARKER_0 까지 포함해야 한다.
-                참고로 offset 은 카피할 필요가 없다. 왜냐하면 offset 이 같으면 같은 스왑공간에 들어간다는 소리기 때문이죠.
-                최초에 vm_claim_page 로 스왑인 된 후, 페이지를 카피하고 나면
-                다시 스왑아웃 할 때. 본인만의 스왑 공간 위치(offset) 을 가지게 됨
-            */
-            if (!vm_alloc_page(type, entry->va, entry->writable))
-            {
-                printf("ANON 페이지 카피 실패\n");
-                return false;
-            }
-            if (!vm_claim_page(entry->va))
-                return false;
-
-            void *dest = spt_find_page(dst, entry->va)->frame->kva;
-            memcpy(dest, entry->frame->kva, PGSIZE);
-        }
+        else if (!vm_fork_page(entry))
+            return false;
     }
 
     // lock_release(&src->page_lock);
@@ -516,9 +1599,76 @@ void hash_destructor(struct hash_elem *e, void *aux){
 void vm_free_frame(struct frame *frame){
     
 	lock_acquire(&frame_lock);
+	if (clock_hand == &frame->f_elem)
+		clock_hand = list_next (clock_hand);
+	if (frame->inode != NULL)
+		hash_delete (&text_cache, &frame->text_elem);
     list_remove(&frame->f_elem);
+	frame_cnt--;
     lock_release(&frame_lock);
     free(frame);
 }
 
+/* Makes PAGE the only user of FRAME. */
+static void
+vm_frame_attach (struct frame *frame, struct page *page) {
+	lock_acquire (&frame_lock);
+	frame->page = page;
+	list_push_back (&frame->sharers, &page->share_elem);
+	frame->ref_cnt++;
+	page->frame = frame;
+	lock_release (&frame_lock);
+}
+
+/* Detaches PAGE from FRAME, handing the frame over to another sharer
+ * if PAGE was its primary page, and returns the number of pages
+ * still sharing FRAME.  FRAME_LOCK must be held. */
+static int
+frame_detach (struct frame *frame, struct page *page) {
+	int remaining;
+
+	list_remove (&page->share_elem);
+	remaining = --frame->ref_cnt;
+	if (frame->page == page)
+		frame->page = remaining > 0
+			? list_entry (list_front (&frame->sharers), struct page, share_elem)
+			: NULL;
+	page->frame = NULL;
+	return remaining;
+}
+
+/* Detaches PAGE, which is about to be destroyed, from its frame.  If
+ * PAGE is being evicted, by kswapd or by another process, waits for
+ * the eviction to finish first.  Stores the frame into *FRAMEP, or a
+ * null pointer if PAGE is not resident, and returns the number of
+ * pages still sharing it; the caller frees the frame when this is
+ * zero. */
+int
+vm_frame_detach (struct page *page, struct frame **framep) {
+	int remaining = -1;
+
+	lock_acquire (&frame_lock);
+	while (page->frame != NULL && page->frame->evicting)
+		cond_wait (&frame_cond, &frame_lock);
+	*framep = page->frame;
+	if (*framep != NULL)
+		remaining = frame_detach (*framep, page);
+	lock_release (&frame_lock);
+	return remaining;
+}
+
+/* Remaps PAGE to KVA in its page table, readable and, if WRITABLE,
+ * writable, keeping the dirty bit of the old mapping so that a
+ * modified file page is still written back. */
+static bool
+vm_protect_page (struct page *page, void *kva, bool writable) {
+	bool dirty = pml4_is_dirty (page->pml4, page->va);
+
+	if (!pml4_set_page (page->pml4, page->va, kva, writable))
+		return false;
+	if (dirty)
+		pml4_set_dirty (page->pml4, page->va, true);
+	return true;
+}
+
 /*--------------------------------------------------------------------*/